@@ -0,0 +1,166 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "graphics_pipeline/color.h"
+#include "graphics_pipeline/scene.h"
+
+// NOLINTBEGIN(readability-magic-numbers)
+
+namespace {
+constexpr int WIDTH = 640;
+constexpr int HEIGHT = 480;
+constexpr unsigned int MESH_COLOR = 0xFF8040FF;
+
+// Counts per frame, reported per second; the console prints them as, for example, triangles=1.5M/s.
+auto GetRate(double count_per_iteration) -> benchmark::Counter {
+  return {count_per_iteration, benchmark::Counter::kIsIterationInvariantRate};
+}
+
+auto GetTriangleCount(const std::vector<TriangleMesh> &meshes) -> long {
+  long ret = 0;
+  for (const auto &mesh : meshes) {
+    ret += static_cast<long>(mesh.triangles.size() / 3);
+  }
+  return ret;
+}
+
+auto MakeCheckerTexture(int size, int square_size) -> Texture {
+  Texture texture;
+  texture.width = size;
+  texture.height = size;
+  texture.pixels.resize(static_cast<long>(size) * size);
+  for (int v_coordinate = 0; v_coordinate < size; v_coordinate++) {
+    for (int u_coordinate = 0; u_coordinate < size; u_coordinate++) {
+      bool is_dark = ((u_coordinate / square_size) + (v_coordinate / square_size)) % 2 == 0;
+      texture.pixels[(static_cast<long>(v_coordinate) * size) + u_coordinate] = is_dark ? 0xFF303030 : 0xFFE0E0E0;
+    }
+  }
+  return texture;
+}
+
+// A corridor of textured walls on both sides of the camera, receding into the distance.
+auto MakeQuadWalls(int wall_count, Texture *texture) -> std::vector<TriangleMesh> {
+  std::vector<TriangleMesh> ret;
+  for (int i = 0; i < wall_count; i++) {
+    float depth = 10.0F + (20.0F * static_cast<float>(i));
+    for (float side : {-1.0F, 1.0F}) {
+      TriangleMesh wall =
+          TriangleMesh::Quad(Vector3(side * 10.0F, 0.0F, depth), Vector3(-side, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F),
+                             20.0F, 16.0F);
+      wall.texture = texture;
+      ret.push_back(wall);
+    }
+  }
+  return ret;
+}
+
+// A square grid of cylinders seen from in front at eye level, so near trees hide far ones.
+auto MakeCylinderForest(int grid_size) -> std::vector<TriangleMesh> {
+  std::vector<TriangleMesh> ret;
+  for (int row = 0; row < grid_size; row++) {
+    for (int column = 0; column < grid_size; column++) {
+      Vector3 position(static_cast<float>(column) * 6.0F, 4.0F, static_cast<float>(row) * 6.0F);
+      ret.push_back(TriangleMesh::Cylinder(position, 1.0F, 8.0F, 16, MESH_COLOR));
+    }
+  }
+  return ret;
+}
+
+// Pixels covered by one draw of the meshes, so the pixel rate counts shaded pixels rather than the whole screen.
+auto CountCoveredPixels(Scene &scene, std::vector<TriangleMesh> &meshes, bool use_lighting) -> long {
+  scene.framebuffer->FillBackground(Color::BLACK);
+  for (auto &mesh : meshes) {
+    scene.DrawMeshFilled(&mesh, use_lighting);
+  }
+
+  const unsigned int *pixels = scene.framebuffer->ResolvePixels();
+  long ret = 0;
+  for (long i = 0; i < static_cast<long>(WIDTH) * HEIGHT; i++) {
+    ret += pixels[i] != Color::BLACK ? 1 : 0;
+  }
+  return ret;
+}
+
+void RunDrawMeshFilled(benchmark::State &state, Scene &scene, std::vector<TriangleMesh> &meshes, bool use_lighting) {
+  long covered_pixels = CountCoveredPixels(scene, meshes, use_lighting);
+  for (auto _ : state) {
+    scene.framebuffer->FillBackground(Color::BLACK);
+    for (auto &mesh : meshes) {
+      scene.DrawMeshFilled(&mesh, use_lighting);
+    }
+    benchmark::DoNotOptimize(scene.framebuffer->ResolvePixels());
+  }
+
+  state.counters["triangles"] = GetRate(static_cast<double>(GetTriangleCount(meshes)));
+  state.counters["pixels"] = GetRate(static_cast<double>(covered_pixels));
+}
+
+void DrawMeshFilledSphere(benchmark::State &state) {
+  Scene scene(WIDTH, HEIGHT);
+  scene.camera->Pose(Vector3(3.0F, 2.0F, -40.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
+  std::vector<TriangleMesh> meshes = {
+      TriangleMesh::Sphere(Vector3(0.0F, 0.0F, 0.0F), 10.0F, static_cast<int>(state.range(0)), MESH_COLOR)};
+  RunDrawMeshFilled(state, scene, meshes, state.range(1) != 0);
+}
+BENCHMARK(DrawMeshFilledSphere)
+    ->ArgsProduct({{4, 5, 6, 7, 8}, {0, 1}})
+    ->ArgNames({"level", "lit"})
+    ->Unit(benchmark::kMillisecond);
+
+void DrawMeshFilledQuadWalls(benchmark::State &state) {
+  Scene scene(WIDTH, HEIGHT);
+  scene.camera->Pose(Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 0.0F, 1.0F), Vector3(0.0F, 1.0F, 0.0F));
+  Texture texture = MakeCheckerTexture(256, 16);
+  std::vector<TriangleMesh> meshes = MakeQuadWalls(static_cast<int>(state.range(0)), &texture);
+  RunDrawMeshFilled(state, scene, meshes, false);
+}
+BENCHMARK(DrawMeshFilledQuadWalls)->Arg(1)->Arg(8)->ArgName("walls")->Unit(benchmark::kMillisecond);
+
+void DrawMeshFilledCylinderForest(benchmark::State &state) {
+  Scene scene(WIDTH, HEIGHT);
+  auto grid_size = static_cast<int>(state.range(0));
+  float extent = static_cast<float>(grid_size) * 6.0F;
+  scene.camera->Pose(Vector3(extent / 2.0F, 4.0F, -20.0F), Vector3(extent / 2.0F, 4.0F, extent),
+                     Vector3(0.0F, 1.0F, 0.0F));
+  std::vector<TriangleMesh> meshes = MakeCylinderForest(grid_size);
+  RunDrawMeshFilled(state, scene, meshes, true);
+}
+BENCHMARK(DrawMeshFilledCylinderForest)->Arg(4)->Arg(16)->Arg(32)->ArgName("grid")->Unit(benchmark::kMillisecond);
+
+void DrawMeshWireframeSphere(benchmark::State &state) {
+  Scene scene(WIDTH, HEIGHT);
+  scene.camera->Pose(Vector3(3.0F, 2.0F, -40.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
+  TriangleMesh mesh =
+      TriangleMesh::Sphere(Vector3(0.0F, 0.0F, 0.0F), 10.0F, static_cast<int>(state.range(0)), MESH_COLOR);
+  for (auto _ : state) {
+    scene.framebuffer->FillBackground(Color::BLACK);
+    scene.DrawMeshWireframe(&mesh, Color::WHITE);
+    benchmark::DoNotOptimize(scene.framebuffer->ResolvePixels());
+  }
+
+  state.counters["triangles"] = GetRate(static_cast<double>(mesh.triangles.size() / 3));
+}
+BENCHMARK(DrawMeshWireframeSphere)->DenseRange(4, 8)->ArgName("level")->Unit(benchmark::kMillisecond);
+
+void SaveTiff(benchmark::State &state) {
+  Scene scene(WIDTH, HEIGHT);
+  scene.camera->Pose(Vector3(3.0F, 2.0F, -40.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
+  TriangleMesh mesh = TriangleMesh::Sphere(Vector3(0.0F, 0.0F, 0.0F), 10.0F, 5, MESH_COLOR);
+  scene.framebuffer->FillBackground(Color::BLACK);
+  scene.DrawMeshFilled(&mesh, true);
+
+  std::string file_name = (std::filesystem::temp_directory_path() / "graphics_pipeline_bench.tif").string();
+  for (auto _ : state) {
+    scene.framebuffer->SaveTiff(file_name.data());
+  }
+  std::filesystem::remove(file_name);
+
+  state.counters["pixels"] = GetRate(static_cast<double>(WIDTH) * HEIGHT);
+}
+BENCHMARK(SaveTiff)->Unit(benchmark::kMillisecond);
+} // namespace
+
+// NOLINTEND(readability-magic-numbers)
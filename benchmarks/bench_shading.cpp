@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "graphics_pipeline/lighting.h"
+#include "graphics_pipeline/planar_pinhole_camera.h"
+#include "graphics_pipeline/texture.h"
+#include "graphics_pipeline/triangle_mesh.h"
+
+// NOLINTBEGIN(readability-magic-numbers)
+
+namespace {
+constexpr int SAMPLE_COUNT = 640 * 480;
+// Fixed so every run shades the same points.
+constexpr unsigned int RANDOM_SEED = 1;
+
+// Counts per iteration, reported per second.
+auto GetRate(double count_per_iteration) -> benchmark::Counter {
+  return {count_per_iteration, benchmark::Counter::kIsIterationInvariantRate};
+}
+
+void RotateAboutAxisSphere(benchmark::State &state) {
+  TriangleMesh mesh =
+      TriangleMesh::Sphere(Vector3(0.0F, 0.0F, 0.0F), 10.0F, static_cast<int>(state.range(0)), 0xFF8040FF);
+  Vector3 axis = Vector3(1.0F, 2.0F, 3.0F).GetNormal();
+  for (auto _ : state) {
+    mesh.RotateAboutAxis(Vector3(0.0F, 0.0F, 0.0F), axis, 0.01F);
+    benchmark::DoNotOptimize(mesh.vertices.data());
+  }
+
+  state.counters["triangles"] = GetRate(static_cast<double>(mesh.triangles.size() / 3));
+  state.counters["vertices"] = GetRate(static_cast<double>(mesh.vertices.size()));
+}
+BENCHMARK(RotateAboutAxisSphere)->DenseRange(4, 8)->ArgName("level")->Unit(benchmark::kMillisecond);
+
+void ProjectPointsSphere(benchmark::State &state) {
+  TriangleMesh mesh =
+      TriangleMesh::Sphere(Vector3(0.0F, 0.0F, 0.0F), 10.0F, static_cast<int>(state.range(0)), 0xFF8040FF);
+  PlanarPinholeCamera camera(640, 480, 1.0F);
+  camera.Pose(Vector3(3.0F, 2.0F, -40.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
+  std::vector<Vector3> screen_points;
+  std::vector<unsigned char> is_projected;
+  for (auto _ : state) {
+    camera.ProjectPoints(mesh.vertices, screen_points, is_projected);
+    benchmark::DoNotOptimize(screen_points.data());
+  }
+
+  state.counters["vertices"] = GetRate(static_cast<double>(mesh.vertices.size()));
+}
+BENCHMARK(ProjectPointsSphere)->DenseRange(4, 8)->ArgName("level")->Unit(benchmark::kMillisecond);
+
+// One shaded pixel per sample: points on a unit sphere lit by a mix of point, directional and spot lights.
+void ComputeLighting(benchmark::State &state) {
+  std::mt19937 generator(RANDOM_SEED);
+  std::uniform_real_distribution<float> distribution(-1.0F, 1.0F);
+  std::vector<Vector3> points(SAMPLE_COUNT);
+  for (auto &point : points) {
+    point = Vector3(distribution(generator), distribution(generator), distribution(generator)).GetNormal();
+  }
+
+  std::vector<Lighting::LightSource> lights(state.range(0));
+  for (int i = 0; i < static_cast<int>(lights.size()); i++) {
+    lights[i].type = static_cast<Lighting::LightSource::Type>(i % 3);
+    lights[i].position = Vector3(static_cast<float>(i) * 5.0F, 50.0F, -20.0F);
+  }
+
+  Lighting lighting;
+  Vector3 view_direction(0.0F, 0.0F, 1.0F);
+  for (auto _ : state) {
+    for (const auto &point : points) {
+      benchmark::DoNotOptimize(lighting.ComputeLighting(point, point, view_direction, lights, 0.2F, 32.0F));
+    }
+  }
+
+  state.counters["pixels"] = GetRate(static_cast<double>(SAMPLE_COUNT));
+}
+BENCHMARK(ComputeLighting)->Arg(1)->Arg(4)->ArgName("lights")->Unit(benchmark::kMillisecond);
+
+// Coherent samples sweep the texture in screen order, as a textured wall does; incoherent samples are random.
+void TextureSample(benchmark::State &state) {
+  Texture texture;
+  texture.width = 512;
+  texture.height = 512;
+  texture.pixels.assign(static_cast<long>(texture.width) * texture.height, 0xFF808080);
+
+  bool is_coherent = state.range(0) != 0;
+  std::mt19937 generator(RANDOM_SEED);
+  std::uniform_real_distribution<float> distribution(-2.0F, 2.0F);
+  std::vector<float> coordinates(SAMPLE_COUNT * 2);
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    coordinates[(i * 2) + 0] = is_coherent ? static_cast<float>(i % 640) / 640.0F : distribution(generator);
+    coordinates[(i * 2) + 1] = is_coherent ? static_cast<float>(i / 640) / 480.0F : distribution(generator);
+  }
+
+  for (auto _ : state) {
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+      benchmark::DoNotOptimize(texture.Sample(coordinates[(i * 2) + 0], coordinates[(i * 2) + 1]));
+    }
+  }
+
+  state.counters["pixels"] = GetRate(static_cast<double>(SAMPLE_COUNT));
+}
+BENCHMARK(TextureSample)->Arg(1)->Arg(0)->ArgName("coherent")->Unit(benchmark::kMillisecond);
+} // namespace
+
+// NOLINTEND(readability-magic-numbers)
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "image_writer.h"
+#include "planar_pinhole_camera.h"
+#include "scene.h"
+
+// Renders a camera path through keyframes offline, one numbered TIFF per frame. Frames are independent, so each
+// worker thread renders whole frames into a Scene of its own. draw_frame runs concurrently on different scenes and
+// must only read what the frames share; TriangleMesh::GetEdges builds its cache on first use, so a mesh drawn as a
+// wireframe needs one call before rendering starts.
+class BatchRenderer {
+public:
+  enum Interpolation : std::uint8_t { LINEAR, NON_LINEAR };
+  using DrawFrame = std::function<void(Scene &scene, int frame_index)>;
+
+  std::vector<PlanarPinholeCamera> keyframes;
+  Interpolation interpolation;
+  ImageWriter::Compression compression;
+  int width, height;
+  int worker_count;
+  BatchRenderer(int _width, int _height, int _worker_count);
+
+  // Appends one keyframe per file, in the PlanarPinholeCamera::LoadText format.
+  void LoadKeyframes(const std::vector<std::string> &file_names);
+
+  // Frames are spaced evenly in time, with the first on the first keyframe and the last on the last one.
+  auto GetCamera(int frame_index, int frame_count) -> PlanarPinholeCamera;
+  static auto GetFileName(const std::string &prefix, int frame_index) -> std::string;
+
+  // Writes prefix_0000.tif, prefix_0001.tif and so on. Each frame starts with a cleared framebuffer and the camera
+  // posed; draw_frame draws the scene. Workers hand finished frames to an ImageWriter and move on to the next frame
+  // while it is encoded and written. Returns false if a frame could not be written.
+  auto Render(int frame_count, const std::string &prefix, const DrawFrame &draw_frame) -> bool;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "vector_3.h"
+
+// Clips camera-space triangles against the near plane and a guard band around the viewport. Triangles entirely
+// outside one viewport plane are rejected; triangles inside the near plane and the guard band pass through unclipped,
+// since the rasterizer already clamps them to the screen.
+class Clipper {
+public:
+  enum Result : std::uint8_t { REJECTED, ACCEPTED, CLIPPED };
+  enum PlaneIndex : std::uint8_t { NEAR, LEFT, RIGHT, TOP, BOTTOM, PLANE_COUNT };
+  static constexpr int MAX_POLYGON_VERTICES = 3 + PLANE_COUNT;
+  static constexpr float GUARD_BAND = 16384.0F;
+  // Clip flags have bit i set when a point is outside viewport plane i, and bit PLANE_COUNT + i when it is outside
+  // guard band plane i.
+  static constexpr std::uint16_t VIEWPORT_FLAGS = (1U << PLANE_COUNT) - 1;
+  static constexpr std::uint16_t GUARD_BAND_FLAGS = VIEWPORT_FLAGS << PLANE_COUNT;
+
+  // source_weights are the barycentric weights of the vertex with respect to the triangle before clipping.
+  struct Vertex {
+    Vector3 camera_point;
+    Vector3 color;
+    Vector3 source_weights;
+  };
+
+  struct Polygon {
+    std::array<Vertex, MAX_POLYGON_VERTICES> vertices;
+    int vertex_count;
+  };
+
+  struct Plane {
+    Vector3 normal;
+    float offset;
+  };
+
+  std::array<Plane, PLANE_COUNT> viewport_planes;
+  std::array<Plane, PLANE_COUNT> guard_band_planes;
+  Clipper();
+
+  void SetFrustum(float focal_length, int width, int height, float near_distance);
+
+  auto GetClipFlags(Vector3 camera_point) -> std::uint16_t;
+  auto ClipTriangle(const std::array<Vertex, 3> &triangle, Polygon &polygon) -> Result;
+  // Takes the clip flags of the triangle's vertices, so that vertices shared between triangles are classified once.
+  auto ClipTriangle(const std::array<Vertex, 3> &triangle, const std::array<std::uint16_t, 3> &clip_flags,
+                    Polygon &polygon) -> Result;
+
+  static auto GetDistance(Plane plane, Vector3 point) -> float;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+#include "vector_3.h"
+
+// Rejects projected triangles before they reach the rasterizer: triangles facing away from the camera, triangles
+// whose snapped vertices are collinear, and triangles whose bounding box contains no pixel center. Coordinates are
+// snapped exactly like TriangleSetup does, so a triangle is culled only if the rasterizer would draw nothing for it
+// or if the facing test discards it.
+class Culler {
+public:
+  enum CullMode : std::uint8_t { CULL_NONE, CULL_BACK, CULL_FRONT };
+  // Winding of front-facing triangles as seen on screen, with v pointing down.
+  enum Winding : std::uint8_t { COUNTER_CLOCKWISE, CLOCKWISE };
+  enum Result : std::uint8_t { VISIBLE, CULLED_FACING, CULLED_ZERO_AREA, CULLED_NO_SAMPLES };
+
+  struct Counters {
+    long tested;
+    long culled_facing;
+    long culled_zero_area;
+    long culled_no_samples;
+  };
+
+  CullMode cull_mode;
+  Winding front_face_winding;
+  bool cull_zero_area;
+  bool cull_no_samples;
+  Counters counters;
+  Culler();
+
+  void ResetCounters();
+
+  // Updates the counters, so it must not be called concurrently.
+  auto Test(Vector3 point_0, Vector3 point_1, Vector3 point_2) -> Result;
+
+  [[nodiscard]] auto IsFacingCulled(Vector3 point_0, Vector3 point_1, Vector3 point_2) const -> bool;
+};
@@ -1,39 +1,147 @@
 #pragma once
 
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <tuple>
 #include <vector>
 
+#include "hierarchical_z_buffer.h"
+#include "span_kernels.h"
+#include "triangle_setup.h"
 #include "vector_3.h"
 
+// A fragment shader names the floats it wants interpolated across a triangle as Varyings, a std::array<float, N>, and
+// returns the packed color of one pixel from them.
+template <typename Shader>
+concept FragmentShader = requires(const Shader &shader, const typename Shader::Varyings &varyings) {
+  requires std::same_as<typename Shader::Varyings, std::array<float, std::tuple_size_v<typename Shader::Varyings>>>;
+  { shader(varyings) } -> std::convertible_to<unsigned int>;
+};
+
+// An offscreen render target. It owns no window or GL context; a Window presents it on screen.
 class Framebuffer {
 public:
+  enum MemoryLayout : std::uint8_t { LINEAR, TILED };
+  static constexpr int LAYOUT_TILE_SIZE = HierarchicalZBuffer::BLOCK_SIZE;
+  // Clears are applied lazily per square tile of this size, the first time anything touches the tile.
+  static constexpr int CLEAR_TILE_SIZE = HierarchicalZBuffer::TILE_SIZE;
+  enum PendingClear : std::uint8_t { CLEAR_NONE = 0, CLEAR_COLOR = 1, CLEAR_DEPTH = 2 };
+  using ShadeSpan = std::function<int(const SpanKernels::Span &span, float delta_v)>;
+  // Per-pixel counts of the fragments that were depth tested, passed the test and were shaded. Fragments the
+  // hierarchical z test rejects count as failed tests. Fills and segments drawn without a depth test count as shaded
+  // only.
+  struct PixelStatistics {
+    std::uint32_t depth_tests;
+    std::uint32_t depth_passes;
+    std::uint32_t shaded_fragments;
+  };
+  enum StatisticsChannel : std::uint8_t { DEPTH_TESTS, DEPTH_PASSES, SHADED_FRAGMENTS };
+  struct TileOverdraw {
+    int tile_u, tile_v;
+    float average_overdraw;
+  };
+  // Overdraw is shaded fragments per pixel shaded at least once; tiles are CLEAR_TILE_SIZE squares.
+  struct OverdrawSummary {
+    long depth_test_count;
+    long depth_pass_count;
+    long shaded_fragment_count;
+    long shaded_pixel_count;
+    float average_depth_complexity;
+    float average_overdraw;
+    // Fraction of the shaded pixels that were shaded more than once.
+    float overshaded_fraction;
+    // Worst first.
+    std::vector<TileOverdraw> worst_tiles;
+  };
+
   std::vector<unsigned int> pixels;
+  std::vector<unsigned int> resolved_pixels;
+  // Only the buffer of the current depth format is allocated. The compact formats store 1/z as an unsigned
+  // normalized code over [0, depth_range]; 24-bit codes sit in the low bits of 32-bit words.
   std::vector<float> z_buffer;
+  std::vector<std::uint32_t> z_buffer_24;
+  std::vector<std::uint16_t> z_buffer_16;
+  SpanKernels::DepthFormat depth_format;
+  float depth_range;
+  std::vector<unsigned int> visibility_buffer;
+  // Allocated only while statistics are enabled, in the layout of pixels. The counts cover the draws since the last
+  // FillBackground.
+  std::vector<PixelStatistics> pixel_statistics;
+  MemoryLayout memory_layout;
+  HierarchicalZBuffer hierarchical_z_buffer;
+  bool use_hierarchical_z;
+  std::vector<std::uint8_t> pending_clears;
+  bool has_pending_clears;
+  unsigned int clear_color;
   int width, height;
-  GLFWwindow *window;
-  Framebuffer(int _width, int _height, const char *title);
-  ~Framebuffer();
+  Framebuffer(int _width, int _height);
 
-  void Render();
   void Resize(int _width, int _height);
 
   void LoadTiff(char *file_name);
   void SaveTiff(char *file_name);
 
+  void SetMemoryLayout(MemoryLayout layout);
+  auto GetStorageSize() -> long;
+  auto GetIndex(int u_coordinate, int v_coordinate) -> long;
+  auto GetRowIndex(int v_coordinate) -> long;
+  auto GetRunEnd(int u_coordinate) -> int;
+  auto GetRunGap() -> int;
+  auto ResolvePixels() -> unsigned int *;
+  // Code that reads or writes pixels or z_buffer directly must first resolve the clears pending over that region.
+  void ResolveClears(int v_coordinate, int begin_u, int end_u);
+  void ResolveAllClears();
+  void MarkPendingClears(PendingClear clear);
+
   auto GetPixel(int u_coordinate, int v_coordinate) -> unsigned int;
   void SetPixel(int u_coordinate, int v_coordinate, unsigned int color);
 
+  void SetDepthFormat(SpanKernels::DepthFormat format);
+  auto HasZBuffer() -> bool;
+  void AllocateZBuffer();
+  // Points span at the depth row starting at row_index in the current format. A row_index of 0 gives a span whose
+  // offsets are buffer indices.
+  void SetDepthRow(SpanKernels::Span &span, long row_index);
+  auto GetStoredDepth(long index) -> float;
+
   auto GetZBuffer(int u_coordinate, int v_coordinate) -> float;
   void SetZBuffer(int u_coordinate, int v_coordinate, float z_value);
   void ClearZBuffer();
 
   auto IsFarther(int u_coordinate, int v_coordinate, float z_value) -> bool;
 
+  void SetStatisticsEnabled(bool enabled);
+  auto HasStatistics() -> bool;
+  void ClearStatistics();
+  // Adds one shaded fragment to each pixel of [begin_u, end_u] in one row, if statistics are enabled.
+  void CountShadedFragments(int v_coordinate, int begin_u, int end_u);
+  auto GetPixelStatistics(int u_coordinate, int v_coordinate) -> PixelStatistics;
+  auto GetOverdrawSummary(int worst_tile_count) -> OverdrawSummary;
+  // Colors each pixel by its count in channel, from black at zero through blue, green and yellow to red at max_count
+  // and above, bottom-up and linear like ResolvePixels.
+  auto ResolveHeatMap(StatisticsChannel channel, int max_count) -> unsigned int *;
+
+  auto HasHierarchicalZ() -> bool;
+  auto IsBlockOccluded(int block_u, int block_v, float max_depth) -> bool;
+  auto IsTileOccluded(int tile_u, int tile_v, float max_depth) -> bool;
+  void RefreshBlock(int block_u, int block_v);
+  void RefreshTile(int tile_u, int tile_v);
+
+  auto GetBounds() -> ClipRectangle;
+  void RasterizeDepthTested(const TriangleSetup &setup, float max_depth, std::vector<unsigned int> &target,
+                            const ShadeSpan &shade_span);
+
+  // Only marks every tile; the color reaches a tile when it is first drawn to or when the frame is resolved.
   void FillBackground(unsigned int color);
+  // Fills [begin_u, end_u] of one row, clipped to the framebuffer.
+  void FillSpan(int v_coordinate, int begin_u, int end_u, unsigned int color);
   void DrawPoint(Vector3 point, int size, unsigned int color);
   void DrawSegment(Vector3 start_point, Vector3 end_point, unsigned int color);
   void DrawSegment(Vector3 start_point, Vector3 end_point, Vector3 start_color, Vector3 end_color);
+  void DrawSegment(Vector3 start_point, Vector3 end_point, Vector3 start_color, Vector3 end_color, float start_depth,
+                   float end_depth);
   void DrawRectangle(int u_coordinate, int v_coordinate, int width, int height, unsigned int color);
   void DrawRectangleFilled(int u_coordinate, int v_coordinate, int width, int height, unsigned int color);
   void DrawCircle(int u_center, int v_center, int radius, unsigned int color);
@@ -42,7 +150,87 @@ public:
   void DrawTriangleFilled(Vector3 point_0, Vector3 point_1, Vector3 point_2, unsigned int color);
   void DrawTriangleFilled(Vector3 point_0, Vector3 point_1, Vector3 point_2, Vector3 color_0, Vector3 color_1,
                           Vector3 color_2, float depth_0, float depth_1, float depth_2);
+  void DrawTriangleFilled(Vector3 point_0, Vector3 point_1, Vector3 point_2, Vector3 color_0, Vector3 color_1,
+                          Vector3 color_2, float depth_0, float depth_1, float depth_2, ClipRectangle clip);
   void DrawTriangleFilled(Vector3 point_0, Vector3 point_1, Vector3 point_2, Vector3 texture_coordinate_0,
                           Vector3 texture_coordinate_1, Vector3 texture_coordinate_2, float depth_0, float depth_1,
                           float depth_2, class Texture *texture);
-};
\ No newline at end of file
+  void DrawTriangleVisibility(Vector3 point_0, Vector3 point_1, Vector3 point_2, float depth_0, float depth_1,
+                              float depth_2, unsigned int triangle_id, ClipRectangle clip);
+  template <FragmentShader Shader>
+  void DrawTriangleShaded(Vector3 point_0, Vector3 point_1, Vector3 point_2,
+                          const typename Shader::Varyings &varyings_0, const typename Shader::Varyings &varyings_1,
+                          const typename Shader::Varyings &varyings_2, float depth_0, float depth_1, float depth_2,
+                          const Shader &shader);
+  template <FragmentShader Shader>
+  void DrawTriangleShaded(Vector3 point_0, Vector3 point_1, Vector3 point_2,
+                          const typename Shader::Varyings &varyings_0, const typename Shader::Varyings &varyings_1,
+                          const typename Shader::Varyings &varyings_2, float depth_0, float depth_1, float depth_2,
+                          const Shader &shader, ClipRectangle clip);
+};
+
+template <FragmentShader Shader>
+void Framebuffer::DrawTriangleShaded(Vector3 point_0, Vector3 point_1, Vector3 point_2,
+                                     const typename Shader::Varyings &varyings_0,
+                                     const typename Shader::Varyings &varyings_1,
+                                     const typename Shader::Varyings &varyings_2, float depth_0, float depth_1,
+                                     float depth_2, const Shader &shader) {
+  DrawTriangleShaded(point_0, point_1, point_2, varyings_0, varyings_1, varyings_2, depth_0, depth_1, depth_2, shader,
+                     GetBounds());
+}
+
+// Varyings are interpolated as value/z next to the 1/z depth and divided by depth per pixel, so they are
+// perspective-correct. The pixel loop is instantiated per shader, so the shader call is inlined into it.
+template <FragmentShader Shader>
+void Framebuffer::DrawTriangleShaded(Vector3 point_0, Vector3 point_1, Vector3 point_2,
+                                     const typename Shader::Varyings &varyings_0,
+                                     const typename Shader::Varyings &varyings_1,
+                                     const typename Shader::Varyings &varyings_2, float depth_0, float depth_1,
+                                     float depth_2, const Shader &shader, ClipRectangle clip) {
+  using Varyings = typename Shader::Varyings;
+  constexpr int VARYING_COUNT = std::tuple_size_v<Varyings>;
+
+  if (!HasZBuffer()) {
+    return;
+  }
+
+  TriangleSetup setup;
+  if (!setup.Initialize(point_0, point_1, point_2, clip)) {
+    return;
+  }
+
+  TriangleSetup::AttributePlane depth_plane = setup.GetPlane(depth_0, depth_1, depth_2);
+  std::array<TriangleSetup::AttributePlane, VARYING_COUNT> varying_planes;
+  for (int i = 0; i < VARYING_COUNT; i++) {
+    varying_planes[i] = setup.GetPlane(varyings_0[i] * depth_0, varyings_1[i] * depth_1, varyings_2[i] * depth_2);
+  }
+
+  RasterizeDepthTested(setup, TriangleSetup::GetMaxDepth(depth_0, depth_1, depth_2), pixels,
+                       [&](const SpanKernels::Span &span, float delta_v) -> int {
+                         SpanKernels::Plane depth = depth_plane.GetRow(delta_v);
+                         std::array<SpanKernels::Plane, VARYING_COUNT> varying_rows;
+                         for (int i = 0; i < VARYING_COUNT; i++) {
+                           varying_rows[i] = varying_planes[i].GetRow(delta_v);
+                         }
+
+                         int written_count = 0;
+                         Varyings varyings;
+                         for (int u_coordinate = span.begin_u; u_coordinate <= span.end_u; u_coordinate++) {
+                           float delta_u = span.GetDeltaU(u_coordinate);
+                           long offset = span.GetOffset(u_coordinate);
+                           float current_depth = depth.At(delta_u);
+                           if (!span.IsNearer(offset, current_depth)) {
+                             continue;
+                           }
+
+                           float inverse_depth = 1.0F / current_depth;
+                           for (int i = 0; i < VARYING_COUNT; i++) {
+                             varyings[i] = varying_rows[i].At(delta_u) * inverse_depth;
+                           }
+                           span.pixel_row[offset] = shader(varyings);
+                           span.StoreDepth(offset, current_depth);
+                           written_count++;
+                         }
+                         return written_count;
+                       });
+}
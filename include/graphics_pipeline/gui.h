@@ -11,4 +11,8 @@ public:
   ~GUI();
 
   void Render();
+
+private:
+  void RenderProfiler();
+  void RenderOverdraw();
 };
\ No newline at end of file
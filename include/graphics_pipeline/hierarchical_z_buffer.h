@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+class HierarchicalZBuffer {
+public:
+  static constexpr int BLOCK_SIZE = 8;
+  static constexpr int TILE_SIZE = 64;
+  static constexpr int BLOCKS_PER_TILE = TILE_SIZE / BLOCK_SIZE;
+
+  struct Bounds {
+    float min_depth, max_depth;
+    bool is_stale;
+  };
+
+  int width, height;
+  int block_columns, block_rows;
+  int tile_columns, tile_rows;
+  std::vector<Bounds> blocks;
+  std::vector<Bounds> tiles;
+  HierarchicalZBuffer();
+
+  void Resize(int _width, int _height);
+  void Clear(float depth);
+
+  auto GetBlock(int block_u, int block_v) -> Bounds &;
+  auto GetTile(int tile_u, int tile_v) -> Bounds &;
+
+  void MarkWritten(int block_u, int block_v, float max_written_depth);
+};
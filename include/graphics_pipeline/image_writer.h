@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "framebuffer.h"
+#include "thread_pool.h"
+
+// Writes TIFFs off the render thread. Submit copies the framebuffer's resolved pixels and returns; a writer thread
+// encodes the strips of each image in parallel and then writes them in order.
+class ImageWriter {
+public:
+  enum Compression : std::uint8_t { UNCOMPRESSED, LZW, DEFLATE };
+  static constexpr int DEFAULT_ROWS_PER_STRIP = 64;
+  // Submit blocks while this many images wait, which bounds the memory held by snapshots.
+  static constexpr int MAX_PENDING_IMAGES = 4;
+
+  // Pixels are in the framebuffer's linear layout, with rows bottom-up.
+  struct Image {
+    std::string file_name;
+    int width, height;
+    std::vector<unsigned int> pixels;
+  };
+
+  Compression compression;
+  int rows_per_strip;
+  ImageWriter(int encoder_thread_count);
+  ~ImageWriter();
+
+  void Submit(Framebuffer *framebuffer, const std::string &file_name);
+  // Returns once every submitted image has been written, with false if any image since the previous Flush failed.
+  auto Flush() -> bool;
+
+  // Writes on the calling thread, encoding strips on thread_pool when it is not null.
+  static auto Write(const char *file_name, int width, int height, const unsigned int *pixels, Compression compression,
+                    int rows_per_strip, ThreadPool *thread_pool) -> bool;
+
+private:
+  ThreadPool encoder_pool;
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable queue_changed;
+  std::deque<Image> pending_images;
+  bool is_writing;
+  bool has_failed;
+  bool stopping;
+
+  void WriterLoop();
+};
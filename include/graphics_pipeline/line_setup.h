@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+#include "triangle_setup.h"
+#include "vector_3.h"
+
+// Segments are walked with an integer Bresenham stepper between the pixels containing their endpoints. Clipping
+// solves for the first and last step inside the clip rectangle in closed form, so a clipped segment covers exactly the
+// pixels the unclipped one would cover there, and pixels outside the clip rectangle are never visited.
+class LineSetup {
+public:
+  // Endpoints farther than this outside the clip rectangle are first clipped in floating point with Liang-Barsky,
+  // which keeps the integer stepper within 64 bits.
+  static constexpr float GUARD_BAND = 65536.0F;
+
+  std::int64_t start_u, start_v;
+  std::int64_t major_delta, minor_delta;
+  int major_sign, minor_sign;
+  bool is_u_major;
+  std::int64_t first_step, last_step;
+  // Maps a step to the parameter of the original, unclipped segment.
+  float parameter_origin, parameter_scale;
+
+  auto Initialize(Vector3 start_point, Vector3 end_point, ClipRectangle clip) -> bool;
+
+  [[nodiscard]] auto GetParameter(std::int64_t step) const -> float;
+
+  // Calls visit(u, v, step) for every pixel from first_step to last_step.
+  template <typename Visit> void Walk(Visit visit) const;
+};
+
+template <typename Visit> void LineSetup::Walk(Visit visit) const {
+  // error = 2 * step * minor_delta + major_delta - 2 * major_delta * minor_offset, kept within [0, 2 * major_delta).
+  std::int64_t double_major = 2 * major_delta;
+  std::int64_t double_minor = 2 * minor_delta;
+  std::int64_t minor_offset = 0;
+  std::int64_t error = major_delta;
+  if (major_delta > 0) {
+    std::int64_t numerator = (first_step * double_minor) + major_delta;
+    minor_offset = numerator / double_major;
+    error = numerator - (minor_offset * double_major);
+  }
+
+  std::int64_t major = (is_u_major ? start_u : start_v) + (major_sign * first_step);
+  std::int64_t minor = (is_u_major ? start_v : start_u) + (minor_sign * minor_offset);
+  for (std::int64_t step = first_step; step <= last_step; step++) {
+    if (is_u_major) {
+      visit(static_cast<int>(major), static_cast<int>(minor), step);
+    } else {
+      visit(static_cast<int>(minor), static_cast<int>(major), step);
+    }
+
+    major += major_sign;
+    error += double_minor;
+    if (error >= double_major) {
+      error -= double_major;
+      minor += minor_sign;
+    }
+  }
+}
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <array>
+#include <vector>
+
+#include "matrix_3x3.h"
 #include "vector_3.h"
 
+// The view transform and focal length are cached. The basis, the size and the field of view are only changed through
+// the methods below, which invalidate the cache; the position is applied outside the cache and stays public.
 class PlanarPinholeCamera {
 public:
-  Vector3 right, up, forward, position;
-  int width, height;
-  float horizontal_fov;
+  Vector3 position;
   PlanarPinholeCamera() = default;
   PlanarPinholeCamera(int _width, int _height, float _horizontal_fov);
 
@@ -15,6 +19,14 @@ public:
 
   auto GetHorizontalFov() -> float;
   void SetHorizontalFov(float new_horizontal_fov);
+  auto GetWidth() -> int;
+  auto GetHeight() -> int;
+  void SetSize(int new_width, int new_height);
+  auto GetRight() -> Vector3;
+  auto GetUp() -> Vector3;
+  auto GetForward() -> Vector3;
+  // The vectors must be orthonormal.
+  void SetBasis(Vector3 new_right, Vector3 new_up, Vector3 new_forward);
 
   void Pan(float angle);
   void Tilt(float angle);
@@ -23,7 +35,14 @@ public:
   void Translate(Vector3 vector);
   void Pose(Vector3 new_position, Vector3 look_at_point, Vector3 up_vector);
 
+  auto GetCameraSpacePoint(Vector3 point) -> Vector3;
+  // GetCameraSpacePoint for a whole array.
+  void TransformPoints(const std::vector<Vector3> &points, std::vector<Vector3> &camera_points);
   auto Project(Vector3 point, Vector3 &projected_point) -> int;
+  // Projects every point to screen coordinates, with 1/z as the third coordinate. A point on or behind the camera
+  // plane gets is_projected 0 and an unusable screen point.
+  void ProjectPoints(const std::vector<Vector3> &points, std::vector<Vector3> &screen_points,
+                     std::vector<unsigned char> &is_projected);
   auto Unproject(int u_coordinate, int v_coordinate, float inverse_depth) -> Vector3;
 
   auto GetViewDirection() -> Vector3;
@@ -33,4 +52,16 @@ public:
       -> PlanarPinholeCamera;
   static auto InterpolateNonLinear(PlanarPinholeCamera *start_camera, PlanarPinholeCamera *end_camera, float time)
       -> PlanarPinholeCamera;
+
+private:
+  Vector3 right, up, forward;
+  int width = 0, height = 0;
+  float horizontal_fov = 0.0F;
+  Matrix3x3 view_matrix;
+  float focal_length;
+  bool is_transform_dirty = true;
+
+  void InvalidateTransform();
+  void UpdateTransform();
+  auto GetViewMatrixElements() -> std::array<float, 9>;
 };
\ No newline at end of file
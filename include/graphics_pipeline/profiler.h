@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Per-frame stage timings and pipeline counters. Every thread records into its own slot with relaxed atomics, so
+// instrumented code takes no lock unless a trace is recording; EndFrame sums the slots and keeps the difference from
+// the previous frame. Recording is off until SetEnabled(true), and then each timer costs two clock reads.
+class Profiler {
+public:
+  // RASTERIZATION_TILE times each tile on the thread that rasterizes it, so its total is CPU time across the pool,
+  // while RASTERIZATION is the wall time of the whole pass.
+  enum Stage : std::uint8_t {
+    DRAW_MESH_FILLED,
+    PROJECTION,
+    CULLING,
+    RASTERIZATION,
+    RASTERIZATION_TILE,
+    SHADING,
+    PRESENT,
+    SAVE_TIFF,
+    STAGE_COUNT
+  };
+  // The triangle counters are in mesh triangles, so culled plus rasterized is the input. SCREEN_TRIANGLES counts the
+  // triangles the rasterizer receives after clipping splits some of them into fans.
+  enum Counter : std::uint8_t {
+    TRIANGLES_IN,
+    TRIANGLES_CULLED,
+    TRIANGLES_RASTERIZED,
+    SCREEN_TRIANGLES,
+    PIXELS_TESTED,
+    PIXELS_WRITTEN,
+    COUNTER_COUNT
+  };
+  static constexpr int FRAME_HISTORY_LENGTH = 120;
+  // Threads beyond this share slots, which stays correct but makes their trace rows merge.
+  static constexpr int MAX_THREAD_SLOTS = 64;
+
+  // Times are in milliseconds.
+  struct FrameStats {
+    double frame_time;
+    std::array<double, STAGE_COUNT> stage_times;
+    std::array<long, COUNTER_COUNT> counters;
+  };
+
+  // Adds the time from construction to destruction to a stage on the calling thread.
+  class ScopedTimer {
+  public:
+    ScopedTimer(Stage _stage);
+    ~ScopedTimer();
+    ScopedTimer(const ScopedTimer &) = delete;
+    auto operator=(const ScopedTimer &) -> ScopedTimer & = delete;
+
+    // Ends the measurement before the timer goes out of scope.
+    void Stop();
+
+  private:
+    Stage stage;
+    std::int64_t start_time;
+    bool is_active;
+  };
+
+  static void SetEnabled(bool enabled);
+  static auto IsEnabled() -> bool;
+
+  static void AddCount(Counter counter, long count);
+
+  // Closes the current frame. Call it from one thread, once per frame.
+  static void EndFrame();
+  // Oldest frame first.
+  static auto GetFrameHistory() -> std::vector<FrameStats>;
+
+  // Trace events are kept from StartTrace until SaveTrace writes them in the Chrome trace event format, which
+  // chrome://tracing and Perfetto load.
+  static void StartTrace();
+  static auto IsTracing() -> bool;
+  static auto SaveTrace(const char *file_name) -> bool;
+
+  static auto GetStageName(Stage stage) -> const char *;
+  static auto GetCounterName(Counter counter) -> const char *;
+};
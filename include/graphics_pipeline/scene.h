@@ -1,20 +1,47 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "clipper.h"
+#include "culler.h"
 #include "framebuffer.h"
-#include "gui.h"
+#include "lighting.h"
 #include "planar_pinhole_camera.h"
+#include "shadow_map.h"
+#include "thread_pool.h"
+#include "tile_binner.h"
 #include "triangle_mesh.h"
 
+// Renders meshes into an offscreen framebuffer. It needs no window, so it also runs headless; the Viewer adds the
+// windows and input for interactive use.
 class Scene {
 public:
-  GUI *gui;
+  struct ProjectedTriangle {
+    std::array<Vector3, 3> screen_points;
+    std::array<Vector3, 3> colors;
+    std::array<float, 3> depths;
+    std::array<Vector3, 3> source_weights;
+    int mesh_triangle_index;
+  };
+
   Framebuffer *framebuffer;
   PlanarPinholeCamera *camera;
-  Scene();
+  ThreadPool *thread_pool;
+  Culler culler;
+  ShadowMap *shadow_map;
+  Lighting lighting;
+  std::vector<Lighting::LightSource> lights;
+  float ambient_coefficient;
+  float specular_exponent;
+  float near_plane_distance;
+  bool use_tiled_rasterization;
+  bool use_visibility_buffer;
+  Scene(int _width, int _height);
+  Scene(int _width, int _height, int thread_count);
   ~Scene();
 
-  void Run();
-
   void Draw3DPoint(Vector3 point, int size, unsigned int color);
   void Draw3DSegment(Vector3 start_point, Vector3 end_point, unsigned int color);
   void Draw3DSegment(Vector3 start_point, Vector3 end_point, Vector3 start_color, Vector3 end_color);
@@ -24,16 +51,37 @@ public:
   void DrawMeshNormals(TriangleMesh *mesh, int size);
   void DrawMeshFilled(TriangleMesh *mesh, bool use_lighting);
 
-  void DBG();
-
 private:
-  static void KeyCallback(GLFWwindow *window, int key, int scan_code, int action, int mods);
-  static void MouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
-  static void CursorPositionCallback(GLFWwindow *window, double u_coordinate, double v_coordinate);
-  static void ScrollCallback(GLFWwindow *window, double u_offset, double v_offset);
-
-  void HandleKeyInput(int key, int action, int mods);
-  void HandleMouseButton(int button, int action, int mods);
-  void HandleCursorPosition(double u_coordinate, double v_coordinate);
-  void HandleScroll(double u_offset, double v_offset);
+  // The forward path's fragment shader. Varyings are the vertex color followed by the barycentric weights with
+  // respect to the mesh triangle, so clipped triangles shade like the triangle they came from.
+  struct MeshShader {
+    using Varyings = std::array<float, 6>;
+    Scene *scene;
+    TriangleMesh *mesh;
+    std::array<unsigned int, 3> indices;
+    bool use_lighting;
+    auto operator()(const Varyings &varyings) const -> unsigned int;
+  };
+
+  Clipper clipper;
+  TileBinner tile_binner;
+  std::vector<ProjectedTriangle> projected_triangles;
+  // Per-vertex results of the last draw. Screen vertices hold 1/z as their third coordinate.
+  std::vector<Vector3> camera_vertices;
+  std::vector<Vector3> screen_vertices;
+  std::vector<std::uint16_t> vertex_clip_flags;
+  std::vector<unsigned char> is_vertex_projected;
+  std::vector<bool> is_triangle_culled;
+
+  void ProcessVertices(TriangleMesh *mesh, float focal_length);
+  void CullProjectedTriangles();
+  void DrawProjectedTriangle(TriangleMesh *mesh, bool use_lighting, int triangle_index, ClipRectangle clip);
+  void DrawProjectedTriangles(TriangleMesh *mesh, bool use_lighting);
+  void DrawProjectedTrianglesTiled(TriangleMesh *mesh, bool use_lighting);
+  void ShadeVisibilityBuffer(TriangleMesh *mesh, bool use_lighting);
+  auto ShadeVisiblePixel(TriangleMesh *mesh, const ProjectedTriangle &triangle, float u_coordinate,
+                         float v_coordinate, bool use_lighting) -> unsigned int;
+  static auto IsFragmentShaded(TriangleMesh *mesh, bool use_lighting) -> bool;
+  auto ShadeFragment(TriangleMesh *mesh, const std::array<unsigned int, 3> &indices, Vector3 color,
+                     Vector3 mesh_weights, bool use_lighting) -> unsigned int;
 };
\ No newline at end of file
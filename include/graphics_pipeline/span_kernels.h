@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+class SpanKernels {
+public:
+  enum InstructionSet : std::uint8_t { SCALAR, SSE2, AVX2 };
+  enum DepthFormat : std::uint8_t { DEPTH_FLOAT32, DEPTH_UNORM24, DEPTH_UNORM16 };
+  static constexpr int RUN_LENGTH = 8;
+  static constexpr float PIXEL_CENTER_OFFSET = 0.5F;
+  static constexpr float UNORM24_MAX = 16777215.0F;
+  static constexpr float UNORM16_MAX = 65535.0F;
+
+  struct Plane {
+    float row_value, u_step;
+
+    [[nodiscard]] auto At(float delta_u) const -> float { return row_value + (u_step * delta_u); }
+  };
+
+  // Every pixel in [begin_u, end_u] is covered; coverage is resolved exactly before a span reaches the kernels.
+  struct Span {
+    int begin_u, end_u;
+    float origin_u;
+    unsigned int *pixel_row;
+    float *depth_row;
+    // The compact formats store truncated depth * depth_code_scale codes in depth_row_24 or depth_row_16 instead of
+    // depth_row, and the depth test compares codes.
+    std::uint32_t *depth_row_24;
+    std::uint16_t *depth_row_16;
+    DepthFormat depth_format;
+    float depth_code_scale;
+    int run_gap;
+
+    // Rows are stored in runs of RUN_LENGTH pixels separated by run_gap elements, which is 0 for a linear layout.
+    [[nodiscard]] auto GetOffset(int u_coordinate) const -> long {
+      return u_coordinate + (static_cast<long>(u_coordinate / RUN_LENGTH) * run_gap);
+    }
+
+    [[nodiscard]] auto GetDeltaU(int u_coordinate) const -> float {
+      return (static_cast<float>(u_coordinate) + PIXEL_CENTER_OFFSET) - origin_u;
+    }
+
+    [[nodiscard]] auto GetDepthCode(float depth) const -> std::uint32_t {
+      float max_code = depth_format == DEPTH_UNORM16 ? UNORM16_MAX : UNORM24_MAX;
+      return static_cast<std::uint32_t>(std::min(max_code, std::max(0.0F, depth * depth_code_scale)));
+    }
+
+    // The test is strict, so a fragment at the stored depth keeps the stored pixel.
+    [[nodiscard]] auto IsNearer(long offset, float depth) const -> bool {
+      switch (depth_format) {
+      case DEPTH_UNORM24:
+        return GetDepthCode(depth) > depth_row_24[offset];
+      case DEPTH_UNORM16:
+        return GetDepthCode(depth) > depth_row_16[offset];
+      default:
+        return !(depth <= depth_row[offset]);
+      }
+    }
+
+    void StoreDepth(long offset, float depth) const {
+      switch (depth_format) {
+      case DEPTH_UNORM24:
+        depth_row_24[offset] = GetDepthCode(depth);
+        break;
+      case DEPTH_UNORM16:
+        depth_row_16[offset] = static_cast<std::uint16_t>(GetDepthCode(depth));
+        break;
+      default:
+        depth_row[offset] = depth;
+        break;
+      }
+    }
+  };
+
+  static auto GetSupportedInstructionSet() -> InstructionSet;
+  static auto GetInstructionSet() -> InstructionSet;
+  static void SetInstructionSet(InstructionSet instruction_set);
+
+  // Fill count contiguous elements, for clearing whole buffers.
+  static void FillBuffer(unsigned int *target, long count, unsigned int value);
+  static void FillBuffer(float *target, long count, float value);
+  static void FillBuffer(std::uint16_t *target, long count, std::uint16_t value);
+  static void FillFlat(const Span &span, unsigned int color);
+  // The depth-tested kernels return the number of pixels that passed the test and were written.
+  static auto FillDepthTested(const Span &span, Plane depth, unsigned int value) -> int;
+  static auto ShadeColor(const Span &span, Plane depth, const std::array<Plane, 3> &color) -> int;
+  // Depth is interpolated as 1/z and the texture planes as coordinate/z, so dividing by depth per pixel recovers
+  // perspective-correct texture coordinates.
+  static auto ShadeTexture(const Span &span, Plane depth, Plane u_texture, Plane v_texture, class Texture *texture)
+      -> int;
+
+  static auto PackColor(float red, float green, float blue) -> unsigned int;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+  ThreadPool(int thread_count);
+  ~ThreadPool();
+
+  auto GetThreadCount() -> int;
+
+  void ParallelFor(int task_count, const std::function<void(int)> &task);
+
+private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable work_available;
+  std::condition_variable work_finished;
+  const std::function<void(int)> *current_task;
+  std::atomic<int> next_task_index;
+  int current_task_count;
+  int busy_workers;
+  long generation;
+  bool stopping;
+
+  void RunTasks();
+  void WorkerLoop();
+};
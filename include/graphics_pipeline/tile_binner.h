@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+#include "framebuffer.h"
+
+class TileBinner {
+public:
+  static constexpr int TILE_SIZE = 64;
+
+  int width, height;
+  int columns, rows;
+  std::vector<std::vector<int>> bins;
+  TileBinner();
+
+  void Reset(int _width, int _height);
+  void Insert(int triangle_index, float min_u, float min_v, float max_u, float max_v);
+
+  auto GetTileCount() -> int;
+  auto GetTileRectangle(int tile_index) -> ClipRectangle;
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <vector>
 
 #include "texture.h"
@@ -7,14 +9,26 @@
 
 class TriangleMesh {
 public:
+  static constexpr int NO_TRIANGLE = -1;
+
+  // An edge shared by two triangles lists both; a boundary edge has NO_TRIANGLE second. Edges shared by more than two
+  // triangles have NO_TRIANGLE in both slots, so they are never culled with a triangle.
+  struct Edge {
+    std::array<unsigned int, 2> vertices;
+    std::array<int, 2> triangles;
+  };
+
   std::vector<Vector3> colors;
   std::vector<Vector3> vertices;
   std::vector<Vector3> normals;
   std::vector<unsigned int> triangles;
   std::vector<float> texture_coordinates;
-  Texture *texture;
+  Texture *texture = nullptr;
   TriangleMesh() = default;
 
+  // Each undirected edge once. The list is rebuilt whenever triangles has changed since the last call.
+  auto GetEdges() -> const std::vector<Edge> &;
+
   void LoadBinary(char *file_name);
   void SaveBinary(char *file_name);
 
@@ -33,4 +47,10 @@ public:
   static auto Cylinder(Vector3 position, float radius, float height, int subdivisions, unsigned int color)
       -> TriangleMesh;
   static auto Quad(Vector3 position, Vector3 normal, Vector3 up_hint, float width, float height) -> TriangleMesh;
+
+private:
+  std::vector<Edge> edges;
+  std::uint64_t edges_checksum = 0;
+
+  auto GetTrianglesChecksum() -> std::uint64_t;
 };
\ No newline at end of file
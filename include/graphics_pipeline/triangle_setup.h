@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "span_kernels.h"
+#include "vector_3.h"
+
+struct ClipRectangle {
+  int min_u, min_v, max_u, max_v;
+};
+
+// Vertices are snapped to 1/256 of a pixel, and coverage is decided with exact 64-bit edge functions evaluated at
+// pixel centers. Pixels exactly on an edge belong to the triangle only if that edge is a top or left edge, so a pixel
+// on an edge shared by two triangles is shaded exactly once.
+class TriangleSetup {
+public:
+  static constexpr int SUBPIXEL_BITS = 8;
+  static constexpr std::int64_t SUBPIXEL_SCALE = std::int64_t{1} << SUBPIXEL_BITS;
+  static constexpr std::int64_t SUBPIXEL_CENTER = SUBPIXEL_SCALE / 2;
+  // Keeps every edge function product within 64 bits.
+  static constexpr float MAX_FIXED_POINT_COORDINATE = 2097152.0F;
+
+  struct AttributePlane {
+    float u_step, v_step, origin_value;
+
+    [[nodiscard]] auto GetRow(float delta_v) const -> SpanKernels::Plane {
+      return {origin_value + (v_step * delta_v), u_step};
+    }
+  };
+
+  // Edge k is opposite vertex k. Attribute planes are relative to vertex 0 so their constants stay small, and each
+  // pixel is evaluated from its own coordinates rather than accumulated along the span.
+  std::array<std::int64_t, 3> edge_u_steps, edge_v_steps, edge_constants, edge_thresholds;
+  std::array<float, 3> u_steps, v_steps;
+  float origin_u, origin_v;
+  float inverse_area;
+  int min_u, max_u, min_v, max_v;
+
+  auto Initialize(Vector3 point_0, Vector3 point_1, Vector3 point_2, ClipRectangle clip) -> bool;
+
+  [[nodiscard]] auto GetSpan(int v_coordinate) const -> SpanKernels::Span;
+  [[nodiscard]] auto GetDeltaV(int v_coordinate) const -> float;
+  [[nodiscard]] auto GetPlane(float value_0, float value_1, float value_2) const -> AttributePlane;
+
+  static auto GetMaxDepth(float depth_0, float depth_1, float depth_2) -> float;
+};
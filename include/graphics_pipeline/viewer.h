@@ -0,0 +1,38 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "gui.h"
+#include "scene.h"
+#include "window.h"
+
+// The interactive front end: presents the scene's framebuffer in a window next to the GUI and moves the camera from
+// keyboard input.
+class Viewer {
+public:
+  Scene *scene;
+  Window *window;
+  GUI *gui;
+  // Presents the overdraw statistics of heat_map_channel instead of the image while the framebuffer collects them.
+  bool show_heat_map;
+  Framebuffer::StatisticsChannel heat_map_channel;
+  int heat_map_max_count;
+  Viewer(int _width, int _height);
+  ~Viewer();
+
+  void Run();
+
+  void DBG();
+
+private:
+  static void KeyCallback(GLFWwindow *window, int key, int scan_code, int action, int mods);
+  static void MouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
+  static void CursorPositionCallback(GLFWwindow *window, double u_coordinate, double v_coordinate);
+  static void ScrollCallback(GLFWwindow *window, double u_offset, double v_offset);
+
+  void HandleKeyInput(int key, int action, int mods);
+  void HandleMouseButton(int button, int action, int mods);
+  void HandleCursorPosition(double u_coordinate, double v_coordinate);
+  void HandleScroll(double u_offset, double v_offset);
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "framebuffer.h"
+
+// Presents a Framebuffer in a GLFW window.
+class Window {
+public:
+  int width, height;
+  GLFWwindow *window;
+  Window(int _width, int _height, const char *title);
+  ~Window();
+
+  void Present(Framebuffer *framebuffer);
+  // Presents _width by _height bottom-up RGBA pixels, such as a framebuffer heat map.
+  void Present(int _width, int _height, const unsigned int *pixels);
+};
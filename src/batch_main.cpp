@@ -0,0 +1,35 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "graphics_pipeline/batch_renderer.h"
+#include "graphics_pipeline/triangle_mesh.h"
+
+constexpr int DEFAULT_WIDTH = 640;
+constexpr int DEFAULT_HEIGHT = 480;
+
+// usage: batch_renderer <mesh.bin> <frame count> <output prefix> <keyframe.txt> <keyframe.txt>...
+auto main(int argc, char *argv[]) -> int {
+  constexpr int FIRST_KEYFRAME_ARGUMENT = 4;
+  if (argc <= FIRST_KEYFRAME_ARGUMENT) {
+    std::cerr << "usage: " << argv[0] << " <mesh.bin> <frame count> <output prefix> <keyframe.txt>..." << '\n';
+    return -1;
+  }
+
+  TriangleMesh mesh;
+  mesh.LoadBinary(argv[1]);
+  int frame_count = std::stoi(argv[2]);
+  std::string prefix = argv[3];
+  std::vector<std::string> keyframe_files(argv + FIRST_KEYFRAME_ARGUMENT, argv + argc);
+
+  BatchRenderer batch_renderer(DEFAULT_WIDTH, DEFAULT_HEIGHT,
+                               static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U)));
+  batch_renderer.LoadKeyframes(keyframe_files);
+  if (!batch_renderer.Render(frame_count, prefix, [&](Scene &scene, int) { scene.DrawMeshFilled(&mesh, true); })) {
+    return -1;
+  }
+
+  return 0;
+}
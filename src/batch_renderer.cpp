@@ -0,0 +1,82 @@
+#include "graphics_pipeline/batch_renderer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+#include "graphics_pipeline/color.h"
+#include "graphics_pipeline/thread_pool.h"
+
+BatchRenderer::BatchRenderer(int _width, int _height, int _worker_count) {
+  interpolation = NON_LINEAR;
+  compression = ImageWriter::UNCOMPRESSED;
+  width = _width;
+  height = _height;
+  worker_count = std::max(_worker_count, 1);
+}
+
+void BatchRenderer::LoadKeyframes(const std::vector<std::string> &file_names) {
+  for (const auto &file_name : file_names) {
+    PlanarPinholeCamera keyframe(width, height, 1.0F);
+    keyframe.LoadText(file_name.c_str());
+    keyframes.push_back(keyframe);
+  }
+}
+
+auto BatchRenderer::GetCamera(int frame_index, int frame_count) -> PlanarPinholeCamera {
+  int last_keyframe = static_cast<int>(keyframes.size()) - 1;
+  PlanarPinholeCamera ret = keyframes[0];
+  if (last_keyframe > 0 && frame_count > 1) {
+    float time = static_cast<float>(frame_index) * static_cast<float>(last_keyframe) /
+                 static_cast<float>(frame_count - 1);
+    int segment = std::min(static_cast<int>(floorf(time)), last_keyframe - 1);
+    float segment_time = time - static_cast<float>(segment);
+    ret = interpolation == LINEAR
+              ? PlanarPinholeCamera::InterpolateLinear(&keyframes[segment], &keyframes[segment + 1], segment_time)
+              : PlanarPinholeCamera::InterpolateNonLinear(&keyframes[segment], &keyframes[segment + 1],
+                                                          segment_time);
+  }
+
+  ret.SetSize(width, height);
+  return ret;
+}
+
+auto BatchRenderer::GetFileName(const std::string &prefix, int frame_index) -> std::string {
+  constexpr int MAX_SUFFIX_LENGTH = 32;
+  std::array<char, MAX_SUFFIX_LENGTH> suffix;
+  std::snprintf(suffix.data(), suffix.size(), "_%04d.tif", frame_index);
+  return prefix + suffix.data();
+}
+
+// Workers take frames from a shared counter rather than a fixed range, since frame costs vary along a path. Each
+// scene's own pool has a single thread: the parallelism is across frames, not within one.
+auto BatchRenderer::Render(int frame_count, const std::string &prefix, const DrawFrame &draw_frame) -> bool {
+  if (keyframes.empty() || frame_count <= 0) {
+    return true;
+  }
+
+  int scene_count = std::min(worker_count, frame_count);
+  std::vector<std::unique_ptr<Scene>> scenes;
+  for (int i = 0; i < scene_count; i++) {
+    scenes.push_back(std::make_unique<Scene>(width, height, 1));
+  }
+
+  ImageWriter image_writer(worker_count);
+  image_writer.compression = compression;
+  std::atomic<int> next_frame(0);
+  ThreadPool thread_pool(scene_count);
+  thread_pool.ParallelFor(scene_count, [&](int worker_index) {
+    Scene &scene = *scenes[worker_index];
+    for (int frame_index = next_frame++; frame_index < frame_count; frame_index = next_frame++) {
+      *scene.camera = GetCamera(frame_index, frame_count);
+      scene.framebuffer->FillBackground(Color::BLACK);
+      draw_frame(scene, frame_index);
+
+      image_writer.Submit(scene.framebuffer, GetFileName(prefix, frame_index));
+    }
+  });
+  return image_writer.Flush();
+}
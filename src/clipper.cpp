@@ -0,0 +1,100 @@
+#include "graphics_pipeline/clipper.h"
+
+#include <algorithm>
+
+namespace {
+// Planes pass through the eye except the near plane. A side plane margin pixels outside the viewport keeps the
+// points whose projection lands inside it on the positive side.
+auto GetPlanes(float focal_length, int width, int height, float near_distance, float margin)
+    -> std::array<Clipper::Plane, Clipper::PLANE_COUNT> {
+  float half_width = static_cast<float>(width) / 2.0F;
+  float half_height = static_cast<float>(height) / 2.0F;
+
+  std::array<Clipper::Plane, Clipper::PLANE_COUNT> ret;
+  ret[Clipper::NEAR] = {Vector3(0.0F, 0.0F, 1.0F), -near_distance};
+  ret[Clipper::LEFT] = {Vector3(focal_length, 0.0F, half_width + margin), 0.0F};
+  ret[Clipper::RIGHT] = {Vector3(-focal_length, 0.0F, half_width + margin), 0.0F};
+  ret[Clipper::TOP] = {Vector3(0.0F, -focal_length, half_height + margin), 0.0F};
+  ret[Clipper::BOTTOM] = {Vector3(0.0F, focal_length, half_height + margin), 0.0F};
+  return ret;
+}
+
+auto Interpolate(Clipper::Vertex start, Clipper::Vertex end, float time) -> Clipper::Vertex {
+  Clipper::Vertex ret;
+  ret.camera_point = start.camera_point + (end.camera_point - start.camera_point) * time;
+  ret.color = start.color + (end.color - start.color) * time;
+  ret.source_weights = start.source_weights + (end.source_weights - start.source_weights) * time;
+  return ret;
+}
+
+// Sutherland-Hodgman against a single plane.
+void ClipPolygon(const Clipper::Polygon &input, Clipper::Plane plane, Clipper::Polygon &output) {
+  output.vertex_count = 0;
+  for (int i = 0; i < input.vertex_count; i++) {
+    const Clipper::Vertex &start = input.vertices[i];
+    const Clipper::Vertex &end = input.vertices[(i + 1) % input.vertex_count];
+    float start_distance = Clipper::GetDistance(plane, start.camera_point);
+    float end_distance = Clipper::GetDistance(plane, end.camera_point);
+
+    if (start_distance >= 0.0F) {
+      output.vertices[output.vertex_count++] = start;
+    }
+    if ((start_distance >= 0.0F) != (end_distance >= 0.0F)) {
+      output.vertices[output.vertex_count++] =
+          Interpolate(start, end, start_distance / (start_distance - end_distance));
+    }
+  }
+}
+} // namespace
+
+Clipper::Clipper() : viewport_planes(), guard_band_planes() {}
+
+void Clipper::SetFrustum(float focal_length, int width, int height, float near_distance) {
+  viewport_planes = GetPlanes(focal_length, width, height, near_distance, 0.0F);
+  guard_band_planes = GetPlanes(focal_length, width, height, near_distance, GUARD_BAND);
+}
+
+auto Clipper::GetClipFlags(Vector3 camera_point) -> std::uint16_t {
+  unsigned int ret = 0;
+  for (int plane_index = 0; plane_index < PLANE_COUNT; plane_index++) {
+    ret |= GetDistance(viewport_planes[plane_index], camera_point) < 0.0F ? 1U << plane_index : 0U;
+    ret |= GetDistance(guard_band_planes[plane_index], camera_point) < 0.0F ? 1U << (PLANE_COUNT + plane_index) : 0U;
+  }
+  return static_cast<std::uint16_t>(ret);
+}
+
+auto Clipper::ClipTriangle(const std::array<Vertex, 3> &triangle, Polygon &polygon) -> Result {
+  std::array<std::uint16_t, 3> clip_flags;
+  for (int i = 0; i < 3; i++) {
+    clip_flags[i] = GetClipFlags(triangle[i].camera_point);
+  }
+  return ClipTriangle(triangle, clip_flags, polygon);
+}
+
+// A triangle is rejected when all its vertices are outside the same viewport plane, and clipped against the guard
+// band planes any of its vertices are outside.
+auto Clipper::ClipTriangle(const std::array<Vertex, 3> &triangle, const std::array<std::uint16_t, 3> &clip_flags,
+                           Polygon &polygon) -> Result {
+  if ((clip_flags[0] & clip_flags[1] & clip_flags[2] & VIEWPORT_FLAGS) != 0) {
+    return REJECTED;
+  }
+
+  unsigned int crossed_planes = static_cast<unsigned int>(clip_flags[0] | clip_flags[1] | clip_flags[2]) >> PLANE_COUNT;
+  polygon.vertex_count = 3;
+  std::copy(triangle.begin(), triangle.end(), polygon.vertices.begin());
+  if (crossed_planes == 0) {
+    return ACCEPTED;
+  }
+
+  Polygon clipped;
+  for (int plane_index = 0; plane_index < PLANE_COUNT && polygon.vertex_count >= 3; plane_index++) {
+    if ((crossed_planes & (1U << plane_index)) != 0) {
+      ClipPolygon(polygon, guard_band_planes[plane_index], clipped);
+      polygon = clipped;
+    }
+  }
+
+  return polygon.vertex_count >= 3 ? CLIPPED : REJECTED;
+}
+
+auto Clipper::GetDistance(Plane plane, Vector3 point) -> float { return plane.normal.Dot(point) + plane.offset; }
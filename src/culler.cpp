@@ -0,0 +1,92 @@
+#include "graphics_pipeline/culler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "graphics_pipeline/triangle_setup.h"
+
+namespace {
+// Twice the signed area in screen space; positive for triangles that are clockwise on screen.
+auto GetSignedArea(Vector3 point_0, Vector3 point_1, Vector3 point_2) -> float {
+  return ((point_1[0] - point_0[0]) * (point_2[1] - point_0[1])) -
+         ((point_1[1] - point_0[1]) * (point_2[0] - point_0[0]));
+}
+
+auto FloorDivide(std::int64_t numerator, std::int64_t denominator) -> std::int64_t {
+  std::int64_t quotient = numerator / denominator;
+  return (numerator % denominator != 0 && numerator < 0) ? quotient - 1 : quotient;
+}
+
+// True if no pixel center lies in [lowest, highest], given in 1/256 pixel units.
+auto MissesPixelCenters(std::int64_t lowest, std::int64_t highest) -> bool {
+  std::int64_t last_center = FloorDivide(highest - TriangleSetup::SUBPIXEL_CENTER, TriangleSetup::SUBPIXEL_SCALE);
+  return (last_center * TriangleSetup::SUBPIXEL_SCALE) + TriangleSetup::SUBPIXEL_CENTER < lowest;
+}
+} // namespace
+
+// Facing culling is opt-in: meshes loaded from files may be wound either way or be open, and culling them by default
+// would drop triangles that used to render.
+Culler::Culler()
+    : cull_mode(CULL_NONE), front_face_winding(COUNTER_CLOCKWISE), cull_zero_area(true), cull_no_samples(true),
+      counters() {}
+
+void Culler::ResetCounters() { counters = Counters(); }
+
+auto Culler::Test(Vector3 point_0, Vector3 point_1, Vector3 point_2) -> Result {
+  counters.tested++;
+
+  if (IsFacingCulled(point_0, point_1, point_2)) {
+    counters.culled_facing++;
+    return CULLED_FACING;
+  }
+
+  if (!cull_zero_area && !cull_no_samples) {
+    return VISIBLE;
+  }
+
+  // Points the rasterizer cannot snap are left for it to reject.
+  std::array<Vector3, 3> points = {point_0, point_1, point_2};
+  std::array<std::int64_t, 3> fixed_u;
+  std::array<std::int64_t, 3> fixed_v;
+  for (int k = 0; k < 3; k++) {
+    if (!(fabsf(points[k][0]) < TriangleSetup::MAX_FIXED_POINT_COORDINATE &&
+          fabsf(points[k][1]) < TriangleSetup::MAX_FIXED_POINT_COORDINATE)) {
+      return VISIBLE;
+    }
+    fixed_u[k] = llroundf(points[k][0] * static_cast<float>(TriangleSetup::SUBPIXEL_SCALE));
+    fixed_v[k] = llroundf(points[k][1] * static_cast<float>(TriangleSetup::SUBPIXEL_SCALE));
+  }
+
+  std::int64_t area = ((fixed_u[1] - fixed_u[0]) * (fixed_v[2] - fixed_v[0])) -
+                      ((fixed_v[1] - fixed_v[0]) * (fixed_u[2] - fixed_u[0]));
+  if (cull_zero_area && area == 0) {
+    counters.culled_zero_area++;
+    return CULLED_ZERO_AREA;
+  }
+
+  if (cull_no_samples &&
+      (MissesPixelCenters(std::min({fixed_u[0], fixed_u[1], fixed_u[2]}),
+                          std::max({fixed_u[0], fixed_u[1], fixed_u[2]})) ||
+       MissesPixelCenters(std::min({fixed_v[0], fixed_v[1], fixed_v[2]}),
+                          std::max({fixed_v[0], fixed_v[1], fixed_v[2]})))) {
+    counters.culled_no_samples++;
+    return CULLED_NO_SAMPLES;
+  }
+
+  return VISIBLE;
+}
+
+auto Culler::IsFacingCulled(Vector3 point_0, Vector3 point_1, Vector3 point_2) const -> bool {
+  if (cull_mode == CULL_NONE) {
+    return false;
+  }
+
+  // Degenerate triangles are left to the zero-area test.
+  float area = GetSignedArea(point_0, point_1, point_2);
+  if (area == 0.0F) {
+    return false;
+  }
+  bool is_front_facing = front_face_winding == CLOCKWISE ? area > 0.0F : area < 0.0F;
+  return cull_mode == CULL_BACK ? !is_front_facing : is_front_facing;
+}
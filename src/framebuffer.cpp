@@ -1,44 +1,114 @@
 #include "graphics_pipeline/framebuffer.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
 #include <iostream>
 #include <tiffio.h>
 
 #include "graphics_pipeline/color.h"
+#include "graphics_pipeline/image_writer.h"
+#include "graphics_pipeline/line_setup.h"
+#include "graphics_pipeline/profiler.h"
+#include "graphics_pipeline/span_kernels.h"
 #include "graphics_pipeline/texture.h"
+#include "graphics_pipeline/triangle_setup.h"
+
+static_assert(Framebuffer::LAYOUT_TILE_SIZE == SpanKernels::RUN_LENGTH);
+
+namespace {
+// Visits the pieces of a row that are contiguous in the framebuffer's memory layout.
+template <typename VisitRun>
+void ForEachRun(Framebuffer &framebuffer, int v_coordinate, int begin_u, int end_u, VisitRun visit_run) {
+  while (begin_u <= end_u) {
+    int run_end = std::min(framebuffer.GetRunEnd(begin_u), end_u);
+    visit_run(framebuffer.GetIndex(begin_u, v_coordinate), begin_u, run_end);
+    begin_u = run_end + 1;
+  }
+}
 
-Framebuffer::Framebuffer(int _width, int _height, const char *title) {
-  width = _width;
-  height = _height;
-  pixels.resize(static_cast<long>(width) * height);
-
-  glfwWindowHint(GLFW_FLOATING, GLFW_TRUE);
-  glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
-  glfwWindowHint(GLFW_DECORATED, GLFW_TRUE);
-  window = glfwCreateWindow(width, height, title, nullptr, nullptr);
-  glfwMakeContextCurrent(window);
-
-  glewInit();
+template <typename Element>
+void CopyToLinear(Framebuffer &framebuffer, const std::vector<Element> &stored, std::vector<Element> &linear) {
+  linear.resize(static_cast<long>(framebuffer.width) * framebuffer.height);
+  for (int v_coordinate = 0; v_coordinate < framebuffer.height; v_coordinate++) {
+    long linear_row = static_cast<long>(framebuffer.height - 1 - v_coordinate) * framebuffer.width;
+    ForEachRun(framebuffer, v_coordinate, 0, framebuffer.width - 1, [&](long index, int begin_u, int end_u) {
+      std::copy_n(stored.begin() + index, end_u - begin_u + 1, linear.begin() + linear_row + begin_u);
+    });
+  }
 }
 
-Framebuffer::~Framebuffer() { glfwDestroyWindow(window); }
+template <typename Element>
+void CopyFromLinear(Framebuffer &framebuffer, const std::vector<Element> &linear, std::vector<Element> &stored) {
+  for (int v_coordinate = 0; v_coordinate < framebuffer.height; v_coordinate++) {
+    long linear_row = static_cast<long>(framebuffer.height - 1 - v_coordinate) * framebuffer.width;
+    ForEachRun(framebuffer, v_coordinate, 0, framebuffer.width - 1, [&](long index, int begin_u, int end_u) {
+      std::copy_n(linear.begin() + linear_row + begin_u, end_u - begin_u + 1, stored.begin() + index);
+    });
+  }
+}
 
-void Framebuffer::Render() {
-  glfwMakeContextCurrent(window);
+// Rearranges a buffer stored in the framebuffer's current layout into layout, leaving memory_layout unchanged.
+template <typename Element>
+void ConvertLayout(Framebuffer &framebuffer, std::vector<Element> &stored, Framebuffer::MemoryLayout layout) {
+  std::vector<Element> linear;
+  Framebuffer::MemoryLayout current_layout = framebuffer.memory_layout;
+  CopyToLinear(framebuffer, stored, linear);
+  framebuffer.memory_layout = layout;
+  stored.assign(framebuffer.GetStorageSize(), Element{});
+  CopyFromLinear(framebuffer, linear, stored);
+  framebuffer.memory_layout = current_layout;
+}
 
-  glDrawPixels(width, height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, pixels.data());
+// The stored depth as the integer the depth test compares, so that any change to it shows.
+auto GetDepthCode(const SpanKernels::Span &span, long offset) -> std::uint32_t {
+  switch (span.depth_format) {
+  case SpanKernels::DEPTH_UNORM24:
+    return span.depth_row_24[offset];
+  case SpanKernels::DEPTH_UNORM16:
+    return span.depth_row_16[offset];
+  default:
+    return std::bit_cast<std::uint32_t>(span.depth_row[offset]);
+  }
+}
 
-  glfwSwapBuffers(window);
+// heat is clamped to [0, 1], which spans black, blue, green, yellow and red in equal steps.
+auto GetHeatColor(float heat) -> unsigned int {
+  std::array<Vector3, 5> stops = {Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 0.0F, 1.0F), Vector3(0.0F, 1.0F, 0.0F),
+                                  Vector3(1.0F, 1.0F, 0.0F), Vector3(1.0F, 0.0F, 0.0F)};
+  float position = std::clamp(heat, 0.0F, 1.0F) * static_cast<float>(stops.size() - 1);
+  int stop = std::min(static_cast<int>(position), static_cast<int>(stops.size()) - 2);
+  float weight = position - static_cast<float>(stop);
+  Vector3 color = (stops[stop] * (1.0F - weight)) + (stops[stop + 1] * weight);
+  return color.GetColor();
+}
+} // namespace
+
+Framebuffer::Framebuffer(int _width, int _height) {
+  use_hierarchical_z = true;
+  has_pending_clears = false;
+  clear_color = 0;
+  memory_layout = LINEAR;
+  depth_format = SpanKernels::DEPTH_FLOAT32;
+  depth_range = 1.0F;
+  width = _width;
+  height = _height;
+  pixels.resize(GetStorageSize());
 }
 
 void Framebuffer::Resize(int _width, int _height) {
+  bool has_statistics = HasStatistics();
   width = _width;
   height = _height;
+  pending_clears.clear();
+  has_pending_clears = false;
   pixels.clear();
-  pixels.resize(static_cast<long>(width) * height);
-
-  glfwSetWindowSize(window, width, height);
+  pixels.resize(GetStorageSize());
+  pixel_statistics.clear();
+  if (has_statistics) {
+    pixel_statistics.resize(GetStorageSize());
+  }
 }
 
 void Framebuffer::LoadTiff(char *file_name) {
@@ -53,32 +123,149 @@ void Framebuffer::LoadTiff(char *file_name) {
   TIFFGetField(input, TIFFTAG_IMAGEWIDTH, &_width);
   TIFFGetField(input, TIFFTAG_IMAGELENGTH, &_height);
   Resize(_width, _height);
-  TIFFReadRGBAImage(input, width, height, pixels.data(), 0);
+  resolved_pixels.resize(static_cast<long>(width) * height);
+  TIFFReadRGBAImage(input, width, height, resolved_pixels.data(), 0);
+  CopyFromLinear(*this, resolved_pixels, pixels);
 
   TIFFClose(input);
 }
 
 void Framebuffer::SaveTiff(char *file_name) {
-  TIFF *output = TIFFOpen(file_name, "w");
-  if (output == nullptr) {
-    std::cerr << file_name << " could not be opened" << '\n';
+  ImageWriter::Write(file_name, width, height, ResolvePixels(), ImageWriter::UNCOMPRESSED,
+                     ImageWriter::DEFAULT_ROWS_PER_STRIP, nullptr);
+}
+
+void Framebuffer::SetMemoryLayout(MemoryLayout layout) {
+  if (layout == memory_layout) {
+    return;
+  }
+
+  ResolveAllClears();
+  if (HasZBuffer()) {
+    switch (depth_format) {
+    case SpanKernels::DEPTH_UNORM24:
+      ConvertLayout(*this, z_buffer_24, layout);
+      break;
+    case SpanKernels::DEPTH_UNORM16:
+      ConvertLayout(*this, z_buffer_16, layout);
+      break;
+    default:
+      ConvertLayout(*this, z_buffer, layout);
+      break;
+    }
+  }
+  if (HasStatistics()) {
+    ConvertLayout(*this, pixel_statistics, layout);
+  }
+  ConvertLayout(*this, pixels, layout);
+  memory_layout = layout;
+}
+
+auto Framebuffer::GetStorageSize() -> long {
+  if (memory_layout == LINEAR) {
+    return static_cast<long>(width) * height;
+  }
+
+  long tile_columns = (width + LAYOUT_TILE_SIZE - 1) / LAYOUT_TILE_SIZE;
+  long tile_rows = (height + LAYOUT_TILE_SIZE - 1) / LAYOUT_TILE_SIZE;
+  return tile_columns * tile_rows * LAYOUT_TILE_SIZE * LAYOUT_TILE_SIZE;
+}
+
+// The linear layout stores rows bottom-up. The tiled layout stores 8x8 tiles one after another, top-down, with the
+// 8 pixels of each tile row contiguous, so a row is a sequence of runs separated by GetRunGap() elements.
+auto Framebuffer::GetIndex(int u_coordinate, int v_coordinate) -> long {
+  if (memory_layout == LINEAR) {
+    return (static_cast<long>(height - 1 - v_coordinate) * width) + u_coordinate;
+  }
+
+  long tile_columns = (width + LAYOUT_TILE_SIZE - 1) / LAYOUT_TILE_SIZE;
+  long tile_index = ((v_coordinate / LAYOUT_TILE_SIZE) * tile_columns) + (u_coordinate / LAYOUT_TILE_SIZE);
+  return (tile_index * LAYOUT_TILE_SIZE * LAYOUT_TILE_SIZE) + ((v_coordinate % LAYOUT_TILE_SIZE) * LAYOUT_TILE_SIZE) +
+         (u_coordinate % LAYOUT_TILE_SIZE);
+}
+
+auto Framebuffer::GetRowIndex(int v_coordinate) -> long { return GetIndex(0, v_coordinate); }
+
+auto Framebuffer::GetRunGap() -> int {
+  if (memory_layout == LINEAR) {
+    return 0;
+  }
+
+  return (LAYOUT_TILE_SIZE * LAYOUT_TILE_SIZE) - LAYOUT_TILE_SIZE;
+}
+
+auto Framebuffer::GetRunEnd(int u_coordinate) -> int {
+  if (memory_layout == LINEAR) {
+    return width - 1;
+  }
+
+  return ((u_coordinate / LAYOUT_TILE_SIZE) * LAYOUT_TILE_SIZE) + LAYOUT_TILE_SIZE - 1;
+}
+
+auto Framebuffer::ResolvePixels() -> unsigned int * {
+  ResolveAllClears();
+  if (memory_layout == LINEAR) {
+    return pixels.data();
+  }
+
+  CopyToLinear(*this, pixels, resolved_pixels);
+  return resolved_pixels.data();
+}
+
+// Tiles never straddle the clip rectangles the tile binner hands to its threads, so threads rasterizing different bins
+// resolve disjoint tiles.
+void Framebuffer::ResolveClears(int v_coordinate, int begin_u, int end_u) {
+  if (!has_pending_clears) {
     return;
   }
 
-  constexpr int SAMPLES_PER_PIXEL = 4;
-  constexpr int BITS_PER_CHANNEL = 8;
-  TIFFSetField(output, TIFFTAG_IMAGEWIDTH, width);
-  TIFFSetField(output, TIFFTAG_IMAGELENGTH, height);
-  TIFFSetField(output, TIFFTAG_SAMPLESPERPIXEL, SAMPLES_PER_PIXEL);
-  TIFFSetField(output, TIFFTAG_BITSPERSAMPLE, BITS_PER_CHANNEL);
-  TIFFSetField(output, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
-  TIFFSetField(output, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-  TIFFSetField(output, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
-  for (int row = 0; row < (unsigned int)height; row++) {
-    TIFFWriteScanline(output, &pixels[(static_cast<long>(height - row - 1)) * width], row);
+  int tile_columns = (width + CLEAR_TILE_SIZE - 1) / CLEAR_TILE_SIZE;
+  int tile_v = v_coordinate / CLEAR_TILE_SIZE;
+  for (int tile_u = begin_u / CLEAR_TILE_SIZE; tile_u <= end_u / CLEAR_TILE_SIZE; tile_u++) {
+    std::uint8_t &pending = pending_clears[(static_cast<long>(tile_v) * tile_columns) + tile_u];
+    if (pending == CLEAR_NONE) {
+      continue;
+    }
+
+    bool has_z_buffer = HasZBuffer();
+    int begin_v = tile_v * CLEAR_TILE_SIZE;
+    int end_v = std::min(begin_v + CLEAR_TILE_SIZE, height) - 1;
+    int tile_begin_u = tile_u * CLEAR_TILE_SIZE;
+    int tile_end_u = std::min(tile_begin_u + CLEAR_TILE_SIZE, width) - 1;
+    for (int row = begin_v; row <= end_v; row++) {
+      ForEachRun(*this, row, tile_begin_u, tile_end_u, [&](long index, int run_begin, int run_end) {
+        if ((pending & CLEAR_COLOR) != 0) {
+          SpanKernels::FillBuffer(&pixels[index], run_end - run_begin + 1, clear_color);
+        }
+        if ((pending & CLEAR_DEPTH) != 0 && has_z_buffer) {
+          long count = run_end - run_begin + 1;
+          switch (depth_format) {
+          case SpanKernels::DEPTH_UNORM24:
+            SpanKernels::FillBuffer(&z_buffer_24[index], count, 0U);
+            break;
+          case SpanKernels::DEPTH_UNORM16:
+            SpanKernels::FillBuffer(&z_buffer_16[index], count, std::uint16_t{0});
+            break;
+          default:
+            SpanKernels::FillBuffer(&z_buffer[index], count, 0.0F);
+            break;
+          }
+        }
+      });
+    }
+    pending = CLEAR_NONE;
+  }
+}
+
+void Framebuffer::ResolveAllClears() {
+  if (!has_pending_clears) {
+    return;
   }
 
-  TIFFClose(output);
+  for (int v_coordinate = 0; v_coordinate < height; v_coordinate += CLEAR_TILE_SIZE) {
+    ResolveClears(v_coordinate, 0, width - 1);
+  }
+  has_pending_clears = false;
 }
 
 auto Framebuffer::GetPixel(int u_coordinate, int v_coordinate) -> unsigned int {
@@ -86,7 +273,8 @@ auto Framebuffer::GetPixel(int u_coordinate, int v_coordinate) -> unsigned int {
     return Color::BLACK;
   }
 
-  long index = (static_cast<long>(height - 1 - v_coordinate) * width) + u_coordinate;
+  ResolveClears(v_coordinate, u_coordinate, u_coordinate);
+  long index = GetIndex(u_coordinate, v_coordinate);
   return pixels[index];
 }
 
@@ -95,17 +283,95 @@ void Framebuffer::SetPixel(int u_coordinate, int v_coordinate, unsigned int colo
     return;
   }
 
-  long index = (static_cast<long>(height - 1 - v_coordinate) * width) + u_coordinate;
+  ResolveClears(v_coordinate, u_coordinate, u_coordinate);
+  long index = GetIndex(u_coordinate, v_coordinate);
   pixels[index] = color;
 }
 
+// The depth contents are dropped; a z-buffer that was allocated is reallocated in the new format and cleared.
+void Framebuffer::SetDepthFormat(SpanKernels::DepthFormat format) {
+  if (format == depth_format) {
+    return;
+  }
+
+  bool has_z_buffer = HasZBuffer();
+  z_buffer = {};
+  z_buffer_24 = {};
+  z_buffer_16 = {};
+  depth_format = format;
+  if (has_z_buffer) {
+    AllocateZBuffer();
+    ClearZBuffer();
+  }
+}
+
+auto Framebuffer::HasZBuffer() -> bool {
+  switch (depth_format) {
+  case SpanKernels::DEPTH_UNORM24:
+    return z_buffer_24.size() == pixels.size();
+  case SpanKernels::DEPTH_UNORM16:
+    return z_buffer_16.size() == pixels.size();
+  default:
+    return z_buffer.size() == pixels.size();
+  }
+}
+
+void Framebuffer::AllocateZBuffer() {
+  switch (depth_format) {
+  case SpanKernels::DEPTH_UNORM24:
+    z_buffer_24.resize(GetStorageSize());
+    break;
+  case SpanKernels::DEPTH_UNORM16:
+    z_buffer_16.resize(GetStorageSize());
+    break;
+  default:
+    z_buffer.resize(GetStorageSize());
+    break;
+  }
+}
+
+void Framebuffer::SetDepthRow(SpanKernels::Span &span, long row_index) {
+  span.depth_row = nullptr;
+  span.depth_row_24 = nullptr;
+  span.depth_row_16 = nullptr;
+  span.depth_format = depth_format;
+  span.depth_code_scale = 0.0F;
+  switch (depth_format) {
+  case SpanKernels::DEPTH_UNORM24:
+    span.depth_row_24 = z_buffer_24.data() + row_index;
+    span.depth_code_scale = SpanKernels::UNORM24_MAX / depth_range;
+    break;
+  case SpanKernels::DEPTH_UNORM16:
+    span.depth_row_16 = z_buffer_16.data() + row_index;
+    span.depth_code_scale = SpanKernels::UNORM16_MAX / depth_range;
+    break;
+  default:
+    span.depth_row = z_buffer.data() + row_index;
+    break;
+  }
+}
+
+// Compact codes decode to the bottom of their interval, so stored depths never exceed the depths that were written
+// and the hierarchical bounds built from them stay conservative.
+auto Framebuffer::GetStoredDepth(long index) -> float {
+  switch (depth_format) {
+  case SpanKernels::DEPTH_UNORM24:
+    return static_cast<float>(z_buffer_24[index]) * depth_range / SpanKernels::UNORM24_MAX;
+  case SpanKernels::DEPTH_UNORM16:
+    return static_cast<float>(z_buffer_16[index]) * depth_range / SpanKernels::UNORM16_MAX;
+  default:
+    return z_buffer[index];
+  }
+}
+
 auto Framebuffer::GetZBuffer(int u_coordinate, int v_coordinate) -> float {
   if (u_coordinate < 0 || u_coordinate >= width || v_coordinate < 0 || v_coordinate >= height) {
     return 0.0F;
   }
 
-  long index = (static_cast<long>(height - 1 - v_coordinate) * width) + u_coordinate;
-  return z_buffer[index];
+  ResolveClears(v_coordinate, u_coordinate, u_coordinate);
+  long index = GetIndex(u_coordinate, v_coordinate);
+  return GetStoredDepth(index);
 }
 
 void Framebuffer::SetZBuffer(int u_coordinate, int v_coordinate, float z_value) {
@@ -113,60 +379,502 @@ void Framebuffer::SetZBuffer(int u_coordinate, int v_coordinate, float z_value)
     return;
   }
 
-  long index = (static_cast<long>(height - 1 - v_coordinate) * width) + u_coordinate;
-  z_buffer[index] = z_value;
+  ResolveClears(v_coordinate, u_coordinate, u_coordinate);
+  long index = GetIndex(u_coordinate, v_coordinate);
+  SpanKernels::Span depth_access;
+  SetDepthRow(depth_access, 0);
+  depth_access.StoreDepth(index, z_value);
+
+  if (HasHierarchicalZ()) {
+    hierarchical_z_buffer.MarkWritten(u_coordinate / HierarchicalZBuffer::BLOCK_SIZE,
+                                      v_coordinate / HierarchicalZBuffer::BLOCK_SIZE, z_value);
+  }
 }
 
-void Framebuffer::ClearZBuffer() { std::ranges::fill(z_buffer.begin(), z_buffer.end(), 0.0F); }
+void Framebuffer::ClearZBuffer() {
+  if (HasZBuffer()) {
+    MarkPendingClears(CLEAR_DEPTH);
+  } else {
+    SpanKernels::FillBuffer(z_buffer.data(), static_cast<long>(z_buffer.size()), 0.0F);
+    SpanKernels::FillBuffer(z_buffer_24.data(), static_cast<long>(z_buffer_24.size()), 0U);
+    SpanKernels::FillBuffer(z_buffer_16.data(), static_cast<long>(z_buffer_16.size()), std::uint16_t{0});
+  }
+
+  hierarchical_z_buffer.Resize(width, height);
+  hierarchical_z_buffer.Clear(0.0F);
+}
 
 auto Framebuffer::IsFarther(int u_coordinate, int v_coordinate, float z_value) -> bool {
   if (u_coordinate < 0 || u_coordinate >= width || v_coordinate < 0 || v_coordinate >= height) {
     return true;
   }
 
-  long index = (static_cast<long>(height - 1 - v_coordinate) * width) + u_coordinate;
-  return z_value <= z_buffer[index];
+  ResolveClears(v_coordinate, u_coordinate, u_coordinate);
+  long index = GetIndex(u_coordinate, v_coordinate);
+  SpanKernels::Span depth_access;
+  SetDepthRow(depth_access, 0);
+  return !depth_access.IsNearer(index, z_value);
+}
+
+void Framebuffer::SetStatisticsEnabled(bool enabled) {
+  if (enabled == HasStatistics()) {
+    return;
+  }
+
+  pixel_statistics = {};
+  if (enabled) {
+    pixel_statistics.resize(GetStorageSize());
+  }
+}
+
+auto Framebuffer::HasStatistics() -> bool { return !pixels.empty() && pixel_statistics.size() == pixels.size(); }
+
+void Framebuffer::ClearStatistics() { std::ranges::fill(pixel_statistics, PixelStatistics{}); }
+
+void Framebuffer::CountShadedFragments(int v_coordinate, int begin_u, int end_u) {
+  if (!HasStatistics()) {
+    return;
+  }
+
+  for (int u_coordinate = begin_u; u_coordinate <= end_u; u_coordinate++) {
+    pixel_statistics[GetIndex(u_coordinate, v_coordinate)].shaded_fragments++;
+  }
+}
+
+auto Framebuffer::GetPixelStatistics(int u_coordinate, int v_coordinate) -> PixelStatistics {
+  if (!HasStatistics() || u_coordinate < 0 || u_coordinate >= width || v_coordinate < 0 || v_coordinate >= height) {
+    return {};
+  }
+
+  return pixel_statistics[GetIndex(u_coordinate, v_coordinate)];
+}
+
+// Depth complexity averages over every pixel of the framebuffer, overdraw only over the pixels that were shaded.
+auto Framebuffer::GetOverdrawSummary(int worst_tile_count) -> OverdrawSummary {
+  OverdrawSummary ret{};
+  if (!HasStatistics()) {
+    return ret;
+  }
+
+  int tile_columns = (width + CLEAR_TILE_SIZE - 1) / CLEAR_TILE_SIZE;
+  int tile_rows = (height + CLEAR_TILE_SIZE - 1) / CLEAR_TILE_SIZE;
+  std::vector<long> tile_fragment_counts(static_cast<long>(tile_columns) * tile_rows, 0);
+  std::vector<long> tile_pixel_counts(tile_fragment_counts.size(), 0);
+  long overshaded_pixel_count = 0;
+  for (int v_coordinate = 0; v_coordinate < height; v_coordinate++) {
+    for (int u_coordinate = 0; u_coordinate < width; u_coordinate++) {
+      const PixelStatistics &statistics = pixel_statistics[GetIndex(u_coordinate, v_coordinate)];
+      ret.depth_test_count += statistics.depth_tests;
+      ret.depth_pass_count += statistics.depth_passes;
+      ret.shaded_fragment_count += statistics.shaded_fragments;
+      if (statistics.shaded_fragments == 0) {
+        continue;
+      }
+
+      ret.shaded_pixel_count++;
+      overshaded_pixel_count += statistics.shaded_fragments > 1 ? 1 : 0;
+      long tile_index = (static_cast<long>(v_coordinate / CLEAR_TILE_SIZE) * tile_columns) +
+                        (u_coordinate / CLEAR_TILE_SIZE);
+      tile_fragment_counts[tile_index] += statistics.shaded_fragments;
+      tile_pixel_counts[tile_index]++;
+    }
+  }
+
+  ret.average_depth_complexity =
+      static_cast<float>(ret.depth_test_count) / static_cast<float>(static_cast<long>(width) * height);
+  if (ret.shaded_pixel_count > 0) {
+    ret.average_overdraw =
+        static_cast<float>(ret.shaded_fragment_count) / static_cast<float>(ret.shaded_pixel_count);
+    ret.overshaded_fraction =
+        static_cast<float>(overshaded_pixel_count) / static_cast<float>(ret.shaded_pixel_count);
+  }
+
+  for (int tile_v = 0; tile_v < tile_rows; tile_v++) {
+    for (int tile_u = 0; tile_u < tile_columns; tile_u++) {
+      long tile_index = (static_cast<long>(tile_v) * tile_columns) + tile_u;
+      if (tile_pixel_counts[tile_index] > 0) {
+        ret.worst_tiles.push_back({tile_u, tile_v,
+                                   static_cast<float>(tile_fragment_counts[tile_index]) /
+                                       static_cast<float>(tile_pixel_counts[tile_index])});
+      }
+    }
+  }
+  std::ranges::stable_sort(ret.worst_tiles, std::ranges::greater(), &TileOverdraw::average_overdraw);
+  ret.worst_tiles.resize(std::min(static_cast<long>(ret.worst_tiles.size()), static_cast<long>(worst_tile_count)));
+  return ret;
+}
+
+auto Framebuffer::ResolveHeatMap(StatisticsChannel channel, int max_count) -> unsigned int * {
+  resolved_pixels.assign(static_cast<long>(width) * height, Color::BLACK);
+  if (!HasStatistics()) {
+    return resolved_pixels.data();
+  }
+
+  float heat_scale = 1.0F / static_cast<float>(std::max(max_count, 1));
+  for (int v_coordinate = 0; v_coordinate < height; v_coordinate++) {
+    long linear_row = static_cast<long>(height - 1 - v_coordinate) * width;
+    for (int u_coordinate = 0; u_coordinate < width; u_coordinate++) {
+      const PixelStatistics &statistics = pixel_statistics[GetIndex(u_coordinate, v_coordinate)];
+      std::uint32_t count = channel == DEPTH_TESTS    ? statistics.depth_tests
+                            : channel == DEPTH_PASSES ? statistics.depth_passes
+                                                      : statistics.shaded_fragments;
+      resolved_pixels[linear_row + u_coordinate] = GetHeatColor(static_cast<float>(count) * heat_scale);
+    }
+  }
+  return resolved_pixels.data();
+}
+
+auto Framebuffer::HasHierarchicalZ() -> bool {
+  return use_hierarchical_z && hierarchical_z_buffer.width == width && hierarchical_z_buffer.height == height &&
+         HasZBuffer();
+}
+
+auto Framebuffer::IsBlockOccluded(int block_u, int block_v, float max_depth) -> bool {
+  if (IsTileOccluded(block_u / HierarchicalZBuffer::BLOCKS_PER_TILE, block_v / HierarchicalZBuffer::BLOCKS_PER_TILE,
+                     max_depth)) {
+    return true;
+  }
+
+  HierarchicalZBuffer::Bounds &block = hierarchical_z_buffer.GetBlock(block_u, block_v);
+  if (block.is_stale && max_depth > block.max_depth) {
+    return false;
+  }
+
+  RefreshBlock(block_u, block_v);
+  return max_depth <= block.min_depth;
+}
+
+auto Framebuffer::IsTileOccluded(int tile_u, int tile_v, float max_depth) -> bool {
+  HierarchicalZBuffer::Bounds &tile = hierarchical_z_buffer.GetTile(tile_u, tile_v);
+  if (tile.is_stale && max_depth > tile.max_depth) {
+    return false;
+  }
+
+  RefreshTile(tile_u, tile_v);
+  return max_depth <= tile.min_depth;
+}
+
+void Framebuffer::RefreshBlock(int block_u, int block_v) {
+  HierarchicalZBuffer::Bounds &block = hierarchical_z_buffer.GetBlock(block_u, block_v);
+  if (!block.is_stale) {
+    return;
+  }
+
+  constexpr int BLOCK_SIZE = HierarchicalZBuffer::BLOCK_SIZE;
+  int begin_u = block_u * BLOCK_SIZE;
+  int end_u = std::min(begin_u + BLOCK_SIZE, width);
+  int begin_v = block_v * BLOCK_SIZE;
+  int end_v = std::min(begin_v + BLOCK_SIZE, height);
+
+  // A block can be marked written without every pixel being drawn, so its tile may still hold a pending clear.
+  for (int v_coordinate = begin_v; v_coordinate < end_v; v_coordinate++) {
+    ResolveClears(v_coordinate, begin_u, end_u - 1);
+  }
+
+  float min_depth = GetStoredDepth(GetIndex(begin_u, begin_v));
+  float max_depth = min_depth;
+  for (int v_coordinate = begin_v; v_coordinate < end_v; v_coordinate++) {
+    long run_index = GetIndex(begin_u, v_coordinate);
+    for (int offset = 0; offset < end_u - begin_u; offset++) {
+      float depth = GetStoredDepth(run_index + offset);
+      min_depth = std::min(min_depth, depth);
+      max_depth = std::max(max_depth, depth);
+    }
+  }
+
+  block = {min_depth, max_depth, false};
 }
 
+void Framebuffer::RefreshTile(int tile_u, int tile_v) {
+  HierarchicalZBuffer::Bounds &tile = hierarchical_z_buffer.GetTile(tile_u, tile_v);
+  if (!tile.is_stale) {
+    return;
+  }
+
+  constexpr int BLOCKS_PER_TILE = HierarchicalZBuffer::BLOCKS_PER_TILE;
+  int begin_u = tile_u * BLOCKS_PER_TILE;
+  int end_u = std::min(begin_u + BLOCKS_PER_TILE, hierarchical_z_buffer.block_columns);
+  int begin_v = tile_v * BLOCKS_PER_TILE;
+  int end_v = std::min(begin_v + BLOCKS_PER_TILE, hierarchical_z_buffer.block_rows);
+
+  RefreshBlock(begin_u, begin_v);
+  HierarchicalZBuffer::Bounds bounds = hierarchical_z_buffer.GetBlock(begin_u, begin_v);
+  for (int block_v = begin_v; block_v < end_v; block_v++) {
+    for (int block_u = begin_u; block_u < end_u; block_u++) {
+      RefreshBlock(block_u, block_v);
+      HierarchicalZBuffer::Bounds &block = hierarchical_z_buffer.GetBlock(block_u, block_v);
+      bounds.min_depth = std::min(bounds.min_depth, block.min_depth);
+      bounds.max_depth = std::max(bounds.max_depth, block.max_depth);
+    }
+  }
+
+  tile = {bounds.min_depth, bounds.max_depth, false};
+}
+
+// shade_span returns how many pixels it wrote, so only blocks that changed need their depth bounds refreshed. Spans
+// point into target, which is pixels or another buffer with the same layout.
+void Framebuffer::RasterizeDepthTested(const TriangleSetup &setup, float max_depth, std::vector<unsigned int> &target,
+                                       const ShadeSpan &shade_span) {
+  auto shade_row = [&](int v_coordinate, int begin_u, int end_u) -> bool {
+    long row_index = GetRowIndex(v_coordinate);
+    SpanKernels::Span span = setup.GetSpan(v_coordinate);
+    span.begin_u = std::max(span.begin_u, begin_u);
+    span.end_u = std::min(span.end_u, end_u);
+    if (span.begin_u > span.end_u) {
+      return false;
+    }
+
+    ResolveClears(v_coordinate, span.begin_u, span.end_u);
+    span.pixel_row = &target[row_index];
+    SetDepthRow(span, row_index);
+    span.run_gap = GetRunGap();
+
+    // A fragment that passes the strict depth test always changes the stored depth, so comparing the stored codes
+    // before and after shade_span finds the passes without the kernels reporting them.
+    bool has_statistics = HasStatistics();
+    thread_local std::vector<std::uint32_t> depth_codes;
+    if (has_statistics) {
+      depth_codes.resize(span.end_u - span.begin_u + 1);
+      for (int u_coordinate = span.begin_u; u_coordinate <= span.end_u; u_coordinate++) {
+        depth_codes[u_coordinate - span.begin_u] = GetDepthCode(span, span.GetOffset(u_coordinate));
+      }
+    }
+
+    int written_count = shade_span(span, setup.GetDeltaV(v_coordinate));
+    if (has_statistics) {
+      // Visibility buffer passes are shaded later, once per pixel.
+      std::uint32_t shaded_per_pass = &target == &pixels ? 1 : 0;
+      for (int u_coordinate = span.begin_u; u_coordinate <= span.end_u; u_coordinate++) {
+        long offset = span.GetOffset(u_coordinate);
+        PixelStatistics &statistics = pixel_statistics[row_index + offset];
+        statistics.depth_tests++;
+        if (GetDepthCode(span, offset) != depth_codes[u_coordinate - span.begin_u]) {
+          statistics.depth_passes++;
+          statistics.shaded_fragments += shaded_per_pass;
+        }
+      }
+    }
+    Profiler::AddCount(Profiler::PIXELS_TESTED, span.end_u - span.begin_u + 1);
+    Profiler::AddCount(Profiler::PIXELS_WRITTEN, written_count);
+    return written_count > 0;
+  };
+
+  // Fragments the hierarchical z test rejects count as failed depth tests, so the statistics do not depend on
+  // use_hierarchical_z.
+  auto count_rejected_rows = [&](int begin_v, int end_v, int begin_u, int end_u) {
+    if (!HasStatistics()) {
+      return;
+    }
+
+    for (int v_coordinate = begin_v; v_coordinate <= end_v; v_coordinate++) {
+      SpanKernels::Span span = setup.GetSpan(v_coordinate);
+      for (int u_coordinate = std::max(span.begin_u, begin_u); u_coordinate <= std::min(span.end_u, end_u);
+           u_coordinate++) {
+        pixel_statistics[GetIndex(u_coordinate, v_coordinate)].depth_tests++;
+      }
+    }
+  };
+
+  if (!HasHierarchicalZ()) {
+    for (int v_coordinate = setup.min_v; v_coordinate <= setup.max_v; v_coordinate++) {
+      shade_row(v_coordinate, setup.min_u, setup.max_u);
+    }
+    return;
+  }
+
+  constexpr int BLOCK_SIZE = HierarchicalZBuffer::BLOCK_SIZE;
+  constexpr int TILE_SIZE = HierarchicalZBuffer::TILE_SIZE;
+  constexpr long MIN_QUERY_AREA = 4L * BLOCK_SIZE * BLOCK_SIZE;
+  int first_block_u = setup.min_u / BLOCK_SIZE;
+  int last_block_u = setup.max_u / BLOCK_SIZE;
+  int first_block_v = setup.min_v / BLOCK_SIZE;
+  int last_block_v = setup.max_v / BLOCK_SIZE;
+
+  long area = static_cast<long>(setup.max_u - setup.min_u + 1) * (setup.max_v - setup.min_v + 1);
+  if (area < MIN_QUERY_AREA) {
+    bool has_written = false;
+    for (int v_coordinate = setup.min_v; v_coordinate <= setup.max_v; v_coordinate++) {
+      has_written = shade_row(v_coordinate, setup.min_u, setup.max_u) || has_written;
+    }
+    for (int block_v = first_block_v; has_written && block_v <= last_block_v; block_v++) {
+      for (int block_u = first_block_u; block_u <= last_block_u; block_u++) {
+        hierarchical_z_buffer.MarkWritten(block_u, block_v, max_depth);
+      }
+    }
+    return;
+  }
+
+  bool is_visible = false;
+  for (int tile_v = setup.min_v / TILE_SIZE; !is_visible && tile_v <= setup.max_v / TILE_SIZE; tile_v++) {
+    for (int tile_u = setup.min_u / TILE_SIZE; !is_visible && tile_u <= setup.max_u / TILE_SIZE; tile_u++) {
+      is_visible = !IsTileOccluded(tile_u, tile_v, max_depth);
+    }
+  }
+  if (!is_visible) {
+    count_rejected_rows(setup.min_v, setup.max_v, setup.min_u, setup.max_u);
+    return;
+  }
+
+  thread_local std::vector<unsigned char> visible_blocks;
+  visible_blocks.resize(last_block_u - first_block_u + 1);
+
+  for (int block_v = first_block_v; block_v <= last_block_v; block_v++) {
+    for (int block_u = first_block_u; block_u <= last_block_u; block_u++) {
+      visible_blocks[block_u - first_block_u] = IsBlockOccluded(block_u, block_v, max_depth) ? 0 : 1;
+    }
+
+    int begin_v = std::max(block_v * BLOCK_SIZE, setup.min_v);
+    int end_v = std::min((block_v * BLOCK_SIZE) + BLOCK_SIZE - 1, setup.max_v);
+    int run_start = first_block_u;
+    while (run_start <= last_block_u) {
+      if (visible_blocks[run_start - first_block_u] == 0) {
+        count_rejected_rows(begin_v, end_v, std::max(run_start * BLOCK_SIZE, setup.min_u),
+                            std::min((run_start * BLOCK_SIZE) + BLOCK_SIZE - 1, setup.max_u));
+        run_start++;
+        continue;
+      }
+
+      int run_end = run_start;
+      while (run_end < last_block_u && visible_blocks[run_end + 1 - first_block_u] != 0) {
+        run_end++;
+      }
+
+      int begin_u = std::max(run_start * BLOCK_SIZE, setup.min_u);
+      int end_u = std::min((run_end * BLOCK_SIZE) + BLOCK_SIZE - 1, setup.max_u);
+      bool has_written = false;
+      for (int v_coordinate = begin_v; v_coordinate <= end_v; v_coordinate++) {
+        has_written = shade_row(v_coordinate, begin_u, end_u) || has_written;
+      }
+
+      for (int block_u = run_start; has_written && block_u <= run_end; block_u++) {
+        hierarchical_z_buffer.MarkWritten(block_u, block_v, max_depth);
+      }
+      run_start = run_end + 1;
+    }
+  }
+}
+
+auto Framebuffer::GetBounds() -> ClipRectangle { return {0, 0, width - 1, height - 1}; }
+
 void Framebuffer::FillBackground(unsigned int color) {
-  for (int i = 0; i < width * height; i++) {
-    pixels[i] = color;
+  // A color still pending is replaced rather than resolved first.
+  clear_color = color;
+  MarkPendingClears(CLEAR_COLOR);
+  if (HasStatistics()) {
+    ClearStatistics();
   }
 }
 
+void Framebuffer::MarkPendingClears(PendingClear clear) {
+  long tile_count = static_cast<long>((width + CLEAR_TILE_SIZE - 1) / CLEAR_TILE_SIZE) *
+                    ((height + CLEAR_TILE_SIZE - 1) / CLEAR_TILE_SIZE);
+  pending_clears.resize(tile_count, CLEAR_NONE);
+  for (auto &pending : pending_clears) {
+    pending |= clear;
+  }
+  has_pending_clears = true;
+}
+
+void Framebuffer::FillSpan(int v_coordinate, int begin_u, int end_u, unsigned int color) {
+  if (v_coordinate < 0 || v_coordinate >= height) {
+    return;
+  }
+
+  SpanKernels::Span span;
+  span.begin_u = std::max(begin_u, 0);
+  span.end_u = std::min(end_u, width - 1);
+  if (span.begin_u > span.end_u) {
+    return;
+  }
+  ResolveClears(v_coordinate, span.begin_u, span.end_u);
+  span.origin_u = 0.0F;
+  span.pixel_row = &pixels[GetRowIndex(v_coordinate)];
+  SetDepthRow(span, 0);
+  span.run_gap = GetRunGap();
+  SpanKernels::FillFlat(span, color);
+  CountShadedFragments(v_coordinate, span.begin_u, span.end_u);
+}
+
 void Framebuffer::DrawPoint(Vector3 point, int size, unsigned int color) {
   int u_coordinate = (int)point[0];
   int v_coordinate = (int)point[1];
 
-  for (int i = v_coordinate - (size / 2); i <= v_coordinate + size / 2; i++) {
-    for (int j = u_coordinate - (size / 2); j <= u_coordinate + size / 2; j++) {
-      SetPixel(j, i, color);
-    }
-  }
+  DrawRectangleFilled(u_coordinate - (size / 2), v_coordinate - (size / 2), ((size / 2) * 2) + 1, ((size / 2) * 2) + 1,
+                      color);
 }
 
 void Framebuffer::DrawSegment(Vector3 start_point, Vector3 end_point, unsigned int color) {
-  start_point[2] = 0.0F;
-  end_point[2] = 0.0F;
-
-  int length = (int)((end_point - start_point).GetMagnitude() + 2);
-  for (int i = 0; i < length; i++) {
-    Vector3 current_point = start_point + (end_point - start_point) * (float)i / (float)(length - 1);
-    SetPixel((int)current_point[0], (int)current_point[1], color);
+  LineSetup setup;
+  if (!setup.Initialize(start_point, end_point, GetBounds())) {
+    return;
   }
+
+  setup.Walk([&](int u_coordinate, int v_coordinate, std::int64_t) {
+    ResolveClears(v_coordinate, u_coordinate, u_coordinate);
+    pixels[GetIndex(u_coordinate, v_coordinate)] = color;
+    CountShadedFragments(v_coordinate, u_coordinate, u_coordinate);
+  });
 }
 
 void Framebuffer::DrawSegment(Vector3 start_point, Vector3 end_point, Vector3 start_color, Vector3 end_color) {
-  start_point[2] = 0.0F;
-  end_point[2] = 0.0F;
+  LineSetup setup;
+  if (!setup.Initialize(start_point, end_point, GetBounds())) {
+    return;
+  }
 
-  int length = (int)((end_point - start_point).GetMagnitude() + 2);
-  for (int i = 0; i < length; i++) {
-    Vector3 current_point = start_point + (end_point - start_point) * (float)i / (float)(length - 1);
-    Vector3 current_color = start_color + (end_color - start_color) * (float)i / (float)(length - 1);
-    unsigned int color = current_color.GetColor();
-    SetPixel((int)current_point[0], (int)current_point[1], color);
+  Vector3 color_delta = end_color - start_color;
+  setup.Walk([&](int u_coordinate, int v_coordinate, std::int64_t step) {
+    ResolveClears(v_coordinate, u_coordinate, u_coordinate);
+    Vector3 color = start_color + (color_delta * setup.GetParameter(step));
+    pixels[GetIndex(u_coordinate, v_coordinate)] = color.GetColor();
+    CountShadedFragments(v_coordinate, u_coordinate, u_coordinate);
+  });
+}
+
+// Depths are 1/z, like the triangle depths, so they interpolate linearly in screen space. A pixel is written only if
+// it is nearer than what the z-buffer holds, and its depth is stored.
+void Framebuffer::DrawSegment(Vector3 start_point, Vector3 end_point, Vector3 start_color, Vector3 end_color,
+                              float start_depth, float end_depth) {
+  if (!HasZBuffer()) {
+    DrawSegment(start_point, end_point, start_color, end_color);
+    return;
+  }
+
+  LineSetup setup;
+  if (!setup.Initialize(start_point, end_point, GetBounds())) {
+    return;
   }
+
+  bool has_hierarchical_z = HasHierarchicalZ();
+  bool has_statistics = HasStatistics();
+  SpanKernels::Span depth_access;
+  SetDepthRow(depth_access, 0);
+  Vector3 color_delta = end_color - start_color;
+  float depth_delta = end_depth - start_depth;
+  setup.Walk([&](int u_coordinate, int v_coordinate, std::int64_t step) {
+    float parameter = setup.GetParameter(step);
+    float depth = start_depth + (depth_delta * parameter);
+    ResolveClears(v_coordinate, u_coordinate, u_coordinate);
+    long index = GetIndex(u_coordinate, v_coordinate);
+    if (has_statistics) {
+      pixel_statistics[index].depth_tests++;
+    }
+    if (!depth_access.IsNearer(index, depth)) {
+      return;
+    }
+
+    if (has_statistics) {
+      pixel_statistics[index].depth_passes++;
+      pixel_statistics[index].shaded_fragments++;
+    }
+    depth_access.StoreDepth(index, depth);
+    Vector3 color = start_color + (color_delta * parameter);
+    pixels[index] = color.GetColor();
+    if (has_hierarchical_z) {
+      hierarchical_z_buffer.MarkWritten(u_coordinate / HierarchicalZBuffer::BLOCK_SIZE,
+                                        v_coordinate / HierarchicalZBuffer::BLOCK_SIZE, depth);
+    }
+  });
 }
 
 void Framebuffer::DrawRectangle(int u_coordinate, int v_coordinate, int width, int height, unsigned int color) {
@@ -182,10 +890,10 @@ void Framebuffer::DrawRectangle(int u_coordinate, int v_coordinate, int width, i
 }
 
 void Framebuffer::DrawRectangleFilled(int u_coordinate, int v_coordinate, int width, int height, unsigned int color) {
-  for (int i = 0; i < height; i++) {
-    for (int j = 0; j < width; j++) {
-      SetPixel(u_coordinate + j, v_coordinate + i, color);
-    }
+  int begin_v = std::max(v_coordinate, 0);
+  int end_v = std::min(v_coordinate + height - 1, this->height - 1);
+  for (int i = begin_v; i <= end_v; i++) {
+    FillSpan(i, u_coordinate, u_coordinate + width - 1, color);
   }
 }
 
@@ -217,12 +925,18 @@ void Framebuffer::DrawCircle(int u_center, int v_center, int radius, unsigned in
   }
 }
 
+// Each row is one span whose half width is the largest integer with half_width^2 + i^2 <= radius^2. Walking the rows
+// away from the center only ever shrinks it, so it is found without a square root.
 void Framebuffer::DrawCircleFilled(int u_center, int v_center, int radius, unsigned int color) {
-  for (int i = -radius; i <= radius; i++) {
-    for (int j = -radius; j <= radius; j++) {
-      if (j * j + i * i <= radius * radius) {
-        SetPixel(u_center + j, v_center + i, color);
-      }
+  int half_width = radius;
+  for (int i = 0; i <= radius; i++) {
+    while ((half_width * half_width) + (i * i) > radius * radius) {
+      half_width--;
+    }
+
+    FillSpan(v_center + i, u_center - half_width, u_center + half_width, color);
+    if (i != 0) {
+      FillSpan(v_center - i, u_center - half_width, u_center + half_width, color);
     }
   }
 }
@@ -234,294 +948,95 @@ void Framebuffer::DrawTriangle(Vector3 point_0, Vector3 point_1, Vector3 point_2
 }
 
 void Framebuffer::DrawTriangleFilled(Vector3 point_0, Vector3 point_1, Vector3 point_2, unsigned int color) {
-  if (point_0[1] > point_1[1]) {
-    std::swap(point_0, point_1);
-  }
-  if (point_0[1] > point_2[1]) {
-    std::swap(point_0, point_2);
-  }
-  if (point_1[1] > point_2[1]) {
-    std::swap(point_1, point_2);
+  TriangleSetup setup;
+  if (!setup.Initialize(point_0, point_1, point_2, GetBounds())) {
+    return;
   }
 
-  auto fill_flat_bottom_triangle = [&](Vector3 vector_0, Vector3 vector_1, Vector3 vector_2) {
-    float inverse_slope_1 = (vector_1[0] - vector_0[0]) / (vector_1[1] - vector_0[1]);
-    float inverse_slope_2 = (vector_2[0] - vector_0[0]) / (vector_2[1] - vector_0[1]);
-
-    float u_1 = vector_0[0];
-    float u_2 = vector_0[0];
-
-    for (int i = (int)vector_0[1]; i <= (int)vector_1[1]; i++) {
-      for (float j = std::min(u_1, u_2); j <= std::max(u_1, u_2); j += 1.0F) {
-        SetPixel((int)j, i, color);
-      }
-      u_1 += inverse_slope_1;
-      u_2 += inverse_slope_2;
-    }
-  };
-
-  auto fill_flat_top_triangle = [&](Vector3 vector_0, Vector3 vector_1, Vector3 vector_2) {
-    float inverse_slope_1 = (vector_2[0] - vector_0[0]) / (vector_2[1] - vector_0[1]);
-    float inverse_slope_2 = (vector_2[0] - vector_1[0]) / (vector_2[1] - vector_1[1]);
-
-    float u_1 = vector_2[0];
-    float u_2 = vector_2[0];
-
-    for (int i = (int)vector_2[1]; i > (int)vector_0[1]; i--) {
-      for (float j = std::min(u_1, u_2); j <= std::max(u_1, u_2); j += 1.0F) {
-        SetPixel((int)j, i, color);
-      }
-      u_1 -= inverse_slope_1;
-      u_2 -= inverse_slope_2;
+  for (int v_coordinate = setup.min_v; v_coordinate <= setup.max_v; v_coordinate++) {
+    SpanKernels::Span span = setup.GetSpan(v_coordinate);
+    if (span.begin_u <= span.end_u) {
+      ResolveClears(v_coordinate, span.begin_u, span.end_u);
     }
-  };
-
-  if (point_1[1] == point_2[1]) {
-    fill_flat_bottom_triangle(point_0, point_1, point_2);
-  } else if (point_0[1] == point_1[1]) {
-    fill_flat_top_triangle(point_0, point_1, point_2);
-  } else {
-    Vector3 point_3;
-    point_3[1] = point_1[1];
-    point_3[0] = point_0[0] + ((point_1[1] - point_0[1]) / (point_2[1] - point_0[1])) * (point_2[0] - point_0[0]);
-    point_3[2] = 0.0F;
-
-    fill_flat_bottom_triangle(point_0, point_1, point_3);
-    fill_flat_top_triangle(point_1, point_3, point_2);
+    span.pixel_row = &pixels[GetRowIndex(v_coordinate)];
+    span.run_gap = GetRunGap();
+    SpanKernels::FillFlat(span, color);
+    CountShadedFragments(v_coordinate, span.begin_u, span.end_u);
   }
 }
 
 void Framebuffer::DrawTriangleFilled(Vector3 point_0, Vector3 point_1, Vector3 point_2, Vector3 color_0,
                                      Vector3 color_1, Vector3 color_2, float depth_0, float depth_1, float depth_2) {
-  if (point_0[1] > point_1[1]) {
-    std::swap(point_0, point_1);
-    std::swap(color_0, color_1);
-    std::swap(depth_0, depth_1);
-  }
-  if (point_0[1] > point_2[1]) {
-    std::swap(point_0, point_2);
-    std::swap(color_0, color_2);
-    std::swap(depth_0, depth_2);
-  }
-  if (point_1[1] > point_2[1]) {
-    std::swap(point_1, point_2);
-    std::swap(color_1, color_2);
-    std::swap(depth_1, depth_2);
-  }
-
-  constexpr float EPSILON = 0.001F;
-
-  auto fill_scanline = [&](int scanline_y, float start_x, float end_x, Vector3 start_color, Vector3 end_color,
-                           float start_depth, float end_depth) {
-    if (start_x > end_x) {
-      std::swap(start_x, end_x);
-      std::swap(start_color, end_color);
-      std::swap(start_depth, end_depth);
-    }
-
-    int begin_x = static_cast<int>(start_x);
-    int finish_x = static_cast<int>(end_x);
-
-    for (int pixel_x = begin_x; pixel_x <= finish_x; pixel_x++) {
-      if (pixel_x < 0 || pixel_x >= width || scanline_y < 0 || scanline_y >= height) {
-        continue;
-      }
-
-      float interpolation_t =
-          (finish_x == begin_x) ? 0.0F : static_cast<float>(pixel_x - begin_x) / static_cast<float>(finish_x - begin_x);
-      float current_depth = start_depth + ((end_depth - start_depth) * interpolation_t);
-
-      if (!IsFarther(pixel_x, scanline_y, current_depth)) {
-        Vector3 current_color = start_color + (end_color - start_color) * interpolation_t;
-        SetPixel(pixel_x, scanline_y, current_color.GetColor());
-        SetZBuffer(pixel_x, scanline_y, current_depth);
-      }
-    }
-  };
-
-  auto interpolate_edge = [](Vector3 start_point, Vector3 end_point, Vector3 start_color, Vector3 end_color,
-                             float start_depth, float end_depth, int scanline_y) -> std::tuple<float, Vector3, float> {
-    constexpr float MIN_HEIGHT_DIFF = 0.1F;
-    if (fabsf(end_point[1] - start_point[1]) < MIN_HEIGHT_DIFF) {
-      return {start_point[0], start_color, start_depth};
-    }
-    float interpolation_t =
-        static_cast<float>(scanline_y - static_cast<int>(start_point[1])) / (end_point[1] - start_point[1]);
-    float interpolated_x = start_point[0] + ((end_point[0] - start_point[0]) * interpolation_t);
-    Vector3 interpolated_color = start_color + (end_color - start_color) * interpolation_t;
-    float interpolated_depth = start_depth + ((end_depth - start_depth) * interpolation_t);
-    return {interpolated_x, interpolated_color, interpolated_depth};
-  };
+  DrawTriangleFilled(point_0, point_1, point_2, color_0, color_1, color_2, depth_0, depth_1, depth_2, GetBounds());
+}
 
-  if (fabsf(point_1[1] - point_2[1]) < EPSILON) {
-    for (int scanline_y = static_cast<int>(point_0[1]); scanline_y <= static_cast<int>(point_1[1]); scanline_y++) {
-      auto [x_left, color_left, depth_left] =
-          interpolate_edge(point_0, point_1, color_0, color_1, depth_0, depth_1, scanline_y);
-      auto [x_right, color_right, depth_right] =
-          interpolate_edge(point_0, point_2, color_0, color_2, depth_0, depth_2, scanline_y);
-      fill_scanline(scanline_y, x_left, x_right, color_left, color_right, depth_left, depth_right);
-    }
+void Framebuffer::DrawTriangleFilled(Vector3 point_0, Vector3 point_1, Vector3 point_2, Vector3 color_0,
+                                     Vector3 color_1, Vector3 color_2, float depth_0, float depth_1, float depth_2,
+                                     ClipRectangle clip) {
+  if (!HasZBuffer()) {
     return;
   }
 
-  if (fabsf(point_0[1] - point_1[1]) < EPSILON) {
-    for (int scanline_y = static_cast<int>(point_0[1]); scanline_y <= static_cast<int>(point_2[1]); scanline_y++) {
-      auto [x_left, color_left, depth_left] =
-          interpolate_edge(point_0, point_2, color_0, color_2, depth_0, depth_2, scanline_y);
-      auto [x_right, color_right, depth_right] =
-          interpolate_edge(point_1, point_2, color_1, color_2, depth_1, depth_2, scanline_y);
-      fill_scanline(scanline_y, x_left, x_right, color_left, color_right, depth_left, depth_right);
-    }
+  TriangleSetup setup;
+  if (!setup.Initialize(point_0, point_1, point_2, clip)) {
     return;
   }
 
-  float middle_t = (point_1[1] - point_0[1]) / (point_2[1] - point_0[1]);
-  Vector3 middle_point;
-  middle_point[0] = point_0[0] + (point_2[0] - point_0[0]) * middle_t;
-  middle_point[1] = point_1[1];
-  middle_point[2] = 0.0F;
-  Vector3 middle_color = color_0 + (color_2 - color_0) * middle_t;
-  float middle_depth = depth_0 + ((depth_2 - depth_0) * middle_t);
-
-  for (int scanline_y = static_cast<int>(point_0[1]); scanline_y <= static_cast<int>(point_1[1]); scanline_y++) {
-    auto [x_left, color_left, depth_left] =
-        interpolate_edge(point_0, point_1, color_0, color_1, depth_0, depth_1, scanline_y);
-    auto [x_right, color_right, depth_right] =
-        interpolate_edge(point_0, middle_point, color_0, middle_color, depth_0, middle_depth, scanline_y);
-    fill_scanline(scanline_y, x_left, x_right, color_left, color_right, depth_left, depth_right);
+  TriangleSetup::AttributePlane depth_plane = setup.GetPlane(depth_0, depth_1, depth_2);
+  std::array<TriangleSetup::AttributePlane, 3> color_planes;
+  for (int channel = 0; channel < 3; channel++) {
+    color_planes[channel] = setup.GetPlane(color_0[channel], color_1[channel], color_2[channel]);
   }
 
-  constexpr int SCANLINE_OFFSET = 1;
-  for (int scanline_y = static_cast<int>(point_1[1]) + SCANLINE_OFFSET; scanline_y <= static_cast<int>(point_2[1]);
-       scanline_y++) {
-    auto [x_left, color_left, depth_left] =
-        interpolate_edge(point_1, point_2, color_1, color_2, depth_1, depth_2, scanline_y);
-    auto [x_right, color_right, depth_right] =
-        interpolate_edge(middle_point, point_2, middle_color, color_2, middle_depth, depth_2, scanline_y);
-    fill_scanline(scanline_y, x_left, x_right, color_left, color_right, depth_left, depth_right);
-  }
+  RasterizeDepthTested(setup, TriangleSetup::GetMaxDepth(depth_0, depth_1, depth_2), pixels,
+                       [&](const SpanKernels::Span &span, float delta_v) -> int {
+                         return SpanKernels::ShadeColor(span, depth_plane.GetRow(delta_v),
+                                                        {color_planes[0].GetRow(delta_v),
+                                                         color_planes[1].GetRow(delta_v),
+                                                         color_planes[2].GetRow(delta_v)});
+                       });
 }
 
 void Framebuffer::DrawTriangleFilled(Vector3 point_0, Vector3 point_1, Vector3 point_2, Vector3 texture_coordinate_0,
                                      Vector3 texture_coordinate_1, Vector3 texture_coordinate_2, float depth_0,
                                      float depth_1, float depth_2, Texture *texture) {
-  if (texture == nullptr || texture->pixels.empty()) {
+  if (texture == nullptr || texture->pixels.empty() || !HasZBuffer()) {
     return;
   }
 
-  if (point_0[1] > point_1[1]) {
-    std::swap(point_0, point_1);
-    std::swap(texture_coordinate_0, texture_coordinate_1);
-    std::swap(depth_0, depth_1);
-  }
-  if (point_0[1] > point_2[1]) {
-    std::swap(point_0, point_2);
-    std::swap(texture_coordinate_0, texture_coordinate_2);
-    std::swap(depth_0, depth_2);
-  }
-  if (point_1[1] > point_2[1]) {
-    std::swap(point_1, point_2);
-    std::swap(texture_coordinate_1, texture_coordinate_2);
-    std::swap(depth_1, depth_2);
+  TriangleSetup setup;
+  if (!setup.Initialize(point_0, point_1, point_2, GetBounds())) {
+    return;
   }
 
-  constexpr float EPSILON = 0.001F;
-
-  auto fill_scanline = [&](int scanline_y, float start_x, float end_x, Vector3 start_texture_coordinate,
-                           Vector3 end_texture_coordinate, float start_depth, float end_depth) {
-    if (start_x > end_x) {
-      std::swap(start_x, end_x);
-      std::swap(start_texture_coordinate, end_texture_coordinate);
-      std::swap(start_depth, end_depth);
-    }
-
-    int begin_x = static_cast<int>(start_x);
-    int finish_x = static_cast<int>(end_x);
-
-    for (int pixel_x = begin_x; pixel_x <= finish_x; pixel_x++) {
-      if (pixel_x < 0 || pixel_x >= width || scanline_y < 0 || scanline_y >= height) {
-        continue;
-      }
-
-      float interpolation_t =
-          (finish_x == begin_x) ? 0.0F : static_cast<float>(pixel_x - begin_x) / static_cast<float>(finish_x - begin_x);
-      float current_depth = start_depth + ((end_depth - start_depth) * interpolation_t);
-
-      if (!IsFarther(pixel_x, scanline_y, current_depth)) {
-        Vector3 current_texture_coordinate =
-            start_texture_coordinate + (end_texture_coordinate - start_texture_coordinate) * interpolation_t;
-        unsigned int color = texture->Sample(current_texture_coordinate[0], current_texture_coordinate[1]);
-        SetPixel(pixel_x, scanline_y, color);
-        SetZBuffer(pixel_x, scanline_y, current_depth);
-      }
-    }
-  };
-
-  auto interpolate_edge = [](Vector3 start_point, Vector3 end_point, Vector3 start_texture_coordinate,
-                             Vector3 end_texture_coordinate, float start_depth, float end_depth,
-                             int scanline_y) -> std::tuple<float, Vector3, float> {
-    constexpr float MIN_HEIGHT_DIFF = 0.1F;
-    if (fabsf(end_point[1] - start_point[1]) < MIN_HEIGHT_DIFF) {
-      return {start_point[0], start_texture_coordinate, start_depth};
-    }
-    float interpolation_t =
-        static_cast<float>(scanline_y - static_cast<int>(start_point[1])) / (end_point[1] - start_point[1]);
-    float interpolated_x = start_point[0] + ((end_point[0] - start_point[0]) * interpolation_t);
-    Vector3 interpolated_texture_coordinate =
-        start_texture_coordinate + (end_texture_coordinate - start_texture_coordinate) * interpolation_t;
-    float interpolated_depth = start_depth + ((end_depth - start_depth) * interpolation_t);
-    return {interpolated_x, interpolated_texture_coordinate, interpolated_depth};
-  };
+  TriangleSetup::AttributePlane depth_plane = setup.GetPlane(depth_0, depth_1, depth_2);
+  TriangleSetup::AttributePlane u_texture_plane = setup.GetPlane(
+      texture_coordinate_0[0] * depth_0, texture_coordinate_1[0] * depth_1, texture_coordinate_2[0] * depth_2);
+  TriangleSetup::AttributePlane v_texture_plane = setup.GetPlane(
+      texture_coordinate_0[1] * depth_0, texture_coordinate_1[1] * depth_1, texture_coordinate_2[1] * depth_2);
+
+  RasterizeDepthTested(setup, TriangleSetup::GetMaxDepth(depth_0, depth_1, depth_2), pixels,
+                       [&](const SpanKernels::Span &span, float delta_v) -> int {
+                         return SpanKernels::ShadeTexture(span, depth_plane.GetRow(delta_v),
+                                                          u_texture_plane.GetRow(delta_v),
+                                                          v_texture_plane.GetRow(delta_v), texture);
+                       });
+}
 
-  if (fabsf(point_1[1] - point_2[1]) < EPSILON) {
-    for (int scanline_y = static_cast<int>(point_0[1]); scanline_y <= static_cast<int>(point_1[1]); scanline_y++) {
-      auto [x_left, texture_coordinate_left, depth_left] =
-          interpolate_edge(point_0, point_1, texture_coordinate_0, texture_coordinate_1, depth_0, depth_1, scanline_y);
-      auto [x_right, texture_coordinate_right, depth_right] =
-          interpolate_edge(point_0, point_2, texture_coordinate_0, texture_coordinate_2, depth_0, depth_2, scanline_y);
-      fill_scanline(scanline_y, x_left, x_right, texture_coordinate_left, texture_coordinate_right, depth_left,
-                    depth_right);
-    }
+void Framebuffer::DrawTriangleVisibility(Vector3 point_0, Vector3 point_1, Vector3 point_2, float depth_0,
+                                         float depth_1, float depth_2, unsigned int triangle_id, ClipRectangle clip) {
+  if (!HasZBuffer() || visibility_buffer.size() != pixels.size()) {
     return;
   }
 
-  if (fabsf(point_0[1] - point_1[1]) < EPSILON) {
-    for (int scanline_y = static_cast<int>(point_0[1]); scanline_y <= static_cast<int>(point_2[1]); scanline_y++) {
-      auto [x_left, texture_coordinate_left, depth_left] =
-          interpolate_edge(point_0, point_2, texture_coordinate_0, texture_coordinate_2, depth_0, depth_2, scanline_y);
-      auto [x_right, texture_coordinate_right, depth_right] =
-          interpolate_edge(point_1, point_2, texture_coordinate_1, texture_coordinate_2, depth_1, depth_2, scanline_y);
-      fill_scanline(scanline_y, x_left, x_right, texture_coordinate_left, texture_coordinate_right, depth_left,
-                    depth_right);
-    }
+  TriangleSetup setup;
+  if (!setup.Initialize(point_0, point_1, point_2, clip)) {
     return;
   }
 
-  float middle_t = (point_1[1] - point_0[1]) / (point_2[1] - point_0[1]);
-  Vector3 middle_point;
-  middle_point[0] = point_0[0] + (point_2[0] - point_0[0]) * middle_t;
-  middle_point[1] = point_1[1];
-  middle_point[2] = 0.0F;
-  Vector3 middle_texture_coordinate = texture_coordinate_0 + (texture_coordinate_2 - texture_coordinate_0) * middle_t;
-  float middle_depth = depth_0 + ((depth_2 - depth_0) * middle_t);
-
-  for (int scanline_y = static_cast<int>(point_0[1]); scanline_y <= static_cast<int>(point_1[1]); scanline_y++) {
-    auto [x_left, texture_coordinate_left, depth_left] =
-        interpolate_edge(point_0, point_1, texture_coordinate_0, texture_coordinate_1, depth_0, depth_1, scanline_y);
-    auto [x_right, texture_coordinate_right, depth_right] = interpolate_edge(
-        point_0, middle_point, texture_coordinate_0, middle_texture_coordinate, depth_0, middle_depth, scanline_y);
-    fill_scanline(scanline_y, x_left, x_right, texture_coordinate_left, texture_coordinate_right, depth_left,
-                  depth_right);
-  }
-
-  constexpr int SCANLINE_OFFSET = 1;
-  for (int scanline_y = static_cast<int>(point_1[1]) + SCANLINE_OFFSET; scanline_y <= static_cast<int>(point_2[1]);
-       scanline_y++) {
-    auto [x_left, texture_coordinate_left, depth_left] =
-        interpolate_edge(point_1, point_2, texture_coordinate_1, texture_coordinate_2, depth_1, depth_2, scanline_y);
-    auto [x_right, texture_coordinate_right, depth_right] = interpolate_edge(
-        middle_point, point_2, middle_texture_coordinate, texture_coordinate_2, middle_depth, depth_2, scanline_y);
-    fill_scanline(scanline_y, x_left, x_right, texture_coordinate_left, texture_coordinate_right, depth_left,
-                  depth_right);
-  }
+  TriangleSetup::AttributePlane depth_plane = setup.GetPlane(depth_0, depth_1, depth_2);
+  RasterizeDepthTested(setup, TriangleSetup::GetMaxDepth(depth_0, depth_1, depth_2), visibility_buffer,
+                       [&](const SpanKernels::Span &span, float delta_v) -> int {
+                         return SpanKernels::FillDepthTested(span, depth_plane.GetRow(delta_v), triangle_id);
+                       });
 }
\ No newline at end of file
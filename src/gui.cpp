@@ -4,9 +4,18 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
-#include "graphics_pipeline/scene.h"
+#include <cfloat>
+#include <string>
+#include <vector>
 
-extern Scene *scene;
+#include "graphics_pipeline/profiler.h"
+#include "graphics_pipeline/viewer.h"
+
+extern Viewer *viewer;
+constexpr float FRAME_GRAPH_HEIGHT = 60.0F;
+constexpr const char *TRACE_FILE_NAME = "trace.json";
+constexpr int WORST_TILE_COUNT = 3;
+constexpr int MAX_HEAT_MAP_COUNT = 16;
 
 GUI::GUI(int _width, int _height, const char *title) {
   width = _width;
@@ -46,10 +55,85 @@ void GUI::Render() {
                                   ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoBringToFrontOnFocus;
   ImGui::Begin("MainPanel", nullptr, window_flags);
   if (ImGui::Button("DBG")) {
-    scene->DBG();
+    viewer->DBG();
   }
+  RenderProfiler();
+  RenderOverdraw();
   ImGui::End();
 
   ImGui::Render();
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+}
+
+// Frame times of the recent frames as a graph, then the stage times and counters of the last frame.
+void GUI::RenderProfiler() {
+  ImGui::Separator();
+  bool is_enabled = Profiler::IsEnabled();
+  if (ImGui::Checkbox("Profile", &is_enabled)) {
+    Profiler::SetEnabled(is_enabled);
+  }
+
+  ImGui::SameLine();
+  if (!Profiler::IsTracing()) {
+    if (ImGui::Button("Record trace")) {
+      Profiler::StartTrace();
+    }
+  } else if (ImGui::Button("Save trace")) {
+    Profiler::SaveTrace(TRACE_FILE_NAME);
+  }
+
+  std::vector<Profiler::FrameStats> history = Profiler::GetFrameHistory();
+  if (history.empty()) {
+    return;
+  }
+
+  std::vector<float> frame_times;
+  for (const auto &frame : history) {
+    frame_times.push_back(static_cast<float>(frame.frame_time));
+  }
+  const Profiler::FrameStats &last_frame = history.back();
+  std::string overlay = std::to_string(last_frame.frame_time) + " ms";
+  ImGui::PlotLines("Frame", frame_times.data(), static_cast<int>(frame_times.size()), 0, overlay.c_str(), 0.0F,
+                   FLT_MAX, ImVec2(0.0F, FRAME_GRAPH_HEIGHT));
+
+  for (int stage = 0; stage < Profiler::STAGE_COUNT; stage++) {
+    ImGui::Text("%-20s %8.3f ms", Profiler::GetStageName(static_cast<Profiler::Stage>(stage)),
+                last_frame.stage_times[stage]);
+  }
+  for (int counter = 0; counter < Profiler::COUNTER_COUNT; counter++) {
+    ImGui::Text("%-20s %10ld", Profiler::GetCounterName(static_cast<Profiler::Counter>(counter)),
+                last_frame.counters[counter]);
+  }
+}
+
+// Per-pixel statistics of the framebuffer, their summary for the current frame and the heat map controls.
+void GUI::RenderOverdraw() {
+  ImGui::Separator();
+  Framebuffer *framebuffer = viewer->scene->framebuffer;
+  bool has_statistics = framebuffer->HasStatistics();
+  if (ImGui::Checkbox("Overdraw", &has_statistics)) {
+    framebuffer->SetStatisticsEnabled(has_statistics);
+  }
+  if (!has_statistics) {
+    return;
+  }
+
+  ImGui::SameLine();
+  ImGui::Checkbox("Heat map", &viewer->show_heat_map);
+  int channel = viewer->heat_map_channel;
+  ImGui::RadioButton("Tests", &channel, Framebuffer::DEPTH_TESTS);
+  ImGui::SameLine();
+  ImGui::RadioButton("Passes", &channel, Framebuffer::DEPTH_PASSES);
+  ImGui::SameLine();
+  ImGui::RadioButton("Shaded", &channel, Framebuffer::SHADED_FRAGMENTS);
+  viewer->heat_map_channel = static_cast<Framebuffer::StatisticsChannel>(channel);
+  ImGui::SliderInt("Red at", &viewer->heat_map_max_count, 1, MAX_HEAT_MAP_COUNT);
+
+  Framebuffer::OverdrawSummary summary = framebuffer->GetOverdrawSummary(WORST_TILE_COUNT);
+  ImGui::Text("%-20s %8.2f", "Depth complexity", summary.average_depth_complexity);
+  ImGui::Text("%-20s %8.2f", "Overdraw", summary.average_overdraw);
+  ImGui::Text("%-20s %7.1f%%", "Shaded twice or more", summary.overshaded_fraction * 100.0F);
+  for (const auto &tile : summary.worst_tiles) {
+    ImGui::Text("Tile (%d, %d) %17.2f", tile.tile_u, tile.tile_v, tile.average_overdraw);
+  }
 }
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "graphics_pipeline/hierarchical_z_buffer.h"
+
+#include <algorithm>
+
+HierarchicalZBuffer::HierarchicalZBuffer()
+    : width(0), height(0), block_columns(0), block_rows(0), tile_columns(0), tile_rows(0) {}
+
+void HierarchicalZBuffer::Resize(int _width, int _height) {
+  if (_width == width && _height == height) {
+    return;
+  }
+
+  width = _width;
+  height = _height;
+  block_columns = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  block_rows = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  tile_columns = (width + TILE_SIZE - 1) / TILE_SIZE;
+  tile_rows = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+  blocks.resize(static_cast<long>(block_columns) * block_rows);
+  tiles.resize(static_cast<long>(tile_columns) * tile_rows);
+}
+
+void HierarchicalZBuffer::Clear(float depth) {
+  std::ranges::fill(blocks, Bounds{depth, depth, false});
+  std::ranges::fill(tiles, Bounds{depth, depth, false});
+}
+
+auto HierarchicalZBuffer::GetBlock(int block_u, int block_v) -> Bounds & {
+  return blocks[(static_cast<long>(block_v) * block_columns) + block_u];
+}
+
+auto HierarchicalZBuffer::GetTile(int tile_u, int tile_v) -> Bounds & {
+  return tiles[(static_cast<long>(tile_v) * tile_columns) + tile_u];
+}
+
+void HierarchicalZBuffer::MarkWritten(int block_u, int block_v, float max_written_depth) {
+  Bounds &block = GetBlock(block_u, block_v);
+  block.max_depth = std::max(block.max_depth, max_written_depth);
+  block.is_stale = true;
+
+  Bounds &tile = GetTile(block_u / BLOCKS_PER_TILE, block_v / BLOCKS_PER_TILE);
+  tile.max_depth = std::max(tile.max_depth, max_written_depth);
+  tile.is_stale = true;
+}
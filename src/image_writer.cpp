@@ -0,0 +1,276 @@
+#include "graphics_pipeline/image_writer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <tiffio.h>
+#include <zlib.h>
+
+#include "graphics_pipeline/profiler.h"
+
+namespace {
+constexpr int BYTES_PER_PIXEL = 4;
+
+// TIFF LZW as libtiff writes it: codes are packed most significant bit first, start at 9 bits and widen one step
+// early, and the table is reset with a clear code before it fills.
+class LzwEncoder {
+public:
+  static constexpr int CLEAR_CODE = 256;
+  static constexpr int END_OF_INFORMATION = 257;
+  static constexpr int FIRST_CODE = 258;
+  static constexpr int MIN_BITS = 9;
+  static constexpr int MAX_BITS = 12;
+  static constexpr int MAX_CODE = (1 << MAX_BITS) - 1;
+  static constexpr int HASH_SIZE = 9001;
+
+  void Encode(const std::uint8_t *data, long size, std::vector<std::uint8_t> &output) {
+    output.clear();
+    bit_buffer = 0;
+    bit_count = 0;
+    ResetTable();
+    PutCode(CLEAR_CODE, output);
+    if (size == 0) {
+      PutCode(END_OF_INFORMATION, output);
+      FlushBits(output);
+      return;
+    }
+
+    int prefix = data[0];
+    for (long i = 1; i < size; i++) {
+      int key = (prefix << 8) | data[i];
+      int slot = FindSlot(key);
+      if (hash_keys[slot] == key) {
+        prefix = hash_codes[slot];
+        continue;
+      }
+
+      PutCode(prefix, output);
+      hash_keys[slot] = key;
+      hash_codes[slot] = static_cast<std::int16_t>(next_code);
+      AddCode(output);
+      prefix = data[i];
+    }
+
+    // The decoder adds a table entry for the last code too, so the code width has to follow it before the end code.
+    PutCode(prefix, output);
+    AddCode(output);
+    PutCode(END_OF_INFORMATION, output);
+    FlushBits(output);
+  }
+
+private:
+  std::array<int, HASH_SIZE> hash_keys;
+  std::array<std::int16_t, HASH_SIZE> hash_codes;
+  std::uint32_t bit_buffer;
+  int bit_count;
+  int next_code;
+  int code_bits;
+
+  void ResetTable() {
+    hash_keys.fill(-1);
+    next_code = FIRST_CODE;
+    code_bits = MIN_BITS;
+  }
+
+  auto FindSlot(int key) -> int {
+    int slot = key % HASH_SIZE;
+    while (hash_keys[slot] != -1 && hash_keys[slot] != key) {
+      slot = slot + 1 == HASH_SIZE ? 0 : slot + 1;
+    }
+    return slot;
+  }
+
+  void AddCode(std::vector<std::uint8_t> &output) {
+    next_code++;
+    if (next_code == MAX_CODE - 1) {
+      PutCode(CLEAR_CODE, output);
+      ResetTable();
+    } else if (next_code > (1 << code_bits) - 1) {
+      code_bits++;
+    }
+  }
+
+  void PutCode(int code, std::vector<std::uint8_t> &output) {
+    bit_buffer = (bit_buffer << code_bits) | static_cast<std::uint32_t>(code);
+    bit_count += code_bits;
+    while (bit_count >= 8) {
+      bit_count -= 8;
+      output.push_back(static_cast<std::uint8_t>(bit_buffer >> bit_count));
+    }
+    bit_buffer &= (1U << bit_count) - 1;
+  }
+
+  void FlushBits(std::vector<std::uint8_t> &output) {
+    if (bit_count > 0) {
+      output.push_back(static_cast<std::uint8_t>(bit_buffer << (8 - bit_count)));
+    }
+  }
+};
+
+// Strip rows are top-down while the pixels are bottom-up.
+void GatherStrip(int width, int height, const unsigned int *pixels, int first_row, int row_count,
+                 std::vector<std::uint8_t> &strip) {
+  long row_bytes = static_cast<long>(width) * BYTES_PER_PIXEL;
+  strip.resize(row_bytes * row_count);
+  for (int row = 0; row < row_count; row++) {
+    const unsigned int *source = &pixels[static_cast<long>(height - 1 - (first_row + row)) * width];
+    std::memcpy(&strip[row * row_bytes], source, row_bytes);
+  }
+}
+
+auto EncodeStrip(const std::vector<std::uint8_t> &raw, ImageWriter::Compression compression,
+                 std::vector<std::uint8_t> &encoded) -> bool {
+  switch (compression) {
+  case ImageWriter::LZW: {
+    thread_local LzwEncoder encoder;
+    encoder.Encode(raw.data(), static_cast<long>(raw.size()), encoded);
+    return true;
+  }
+  case ImageWriter::DEFLATE: {
+    uLongf encoded_size = compressBound(raw.size());
+    encoded.resize(encoded_size);
+    if (compress2(encoded.data(), &encoded_size, raw.data(), raw.size(), Z_DEFAULT_COMPRESSION) != Z_OK) {
+      return false;
+    }
+    encoded.resize(encoded_size);
+    return true;
+  }
+  default:
+    encoded = raw;
+    return true;
+  }
+}
+
+auto GetTiffCompression(ImageWriter::Compression compression) -> int {
+  switch (compression) {
+  case ImageWriter::LZW:
+    return COMPRESSION_LZW;
+  case ImageWriter::DEFLATE:
+    return COMPRESSION_ADOBE_DEFLATE;
+  default:
+    return COMPRESSION_NONE;
+  }
+}
+} // namespace
+
+ImageWriter::ImageWriter(int encoder_thread_count)
+    : compression(UNCOMPRESSED), rows_per_strip(DEFAULT_ROWS_PER_STRIP),
+      encoder_pool(std::max(encoder_thread_count, 1)), is_writing(false), has_failed(false), stopping(false) {
+  writer = std::thread(&ImageWriter::WriterLoop, this);
+}
+
+ImageWriter::~ImageWriter() {
+  Flush();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  queue_changed.notify_all();
+  writer.join();
+}
+
+// The compression settings in effect when an image is written apply to it, so change them only between flushes.
+void ImageWriter::Submit(Framebuffer *framebuffer, const std::string &file_name) {
+  Image image;
+  image.file_name = file_name;
+  image.width = framebuffer->width;
+  image.height = framebuffer->height;
+  const unsigned int *pixels = framebuffer->ResolvePixels();
+  image.pixels.assign(pixels, pixels + (static_cast<long>(image.width) * image.height));
+
+  std::unique_lock<std::mutex> lock(mutex);
+  queue_changed.wait(lock, [&] { return static_cast<int>(pending_images.size()) < MAX_PENDING_IMAGES; });
+  pending_images.push_back(std::move(image));
+  queue_changed.notify_all();
+}
+
+auto ImageWriter::Flush() -> bool {
+  std::unique_lock<std::mutex> lock(mutex);
+  queue_changed.wait(lock, [&] { return pending_images.empty() && !is_writing; });
+  bool ret = !has_failed;
+  has_failed = false;
+  return ret;
+}
+
+void ImageWriter::WriterLoop() {
+  while (true) {
+    Image image;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      queue_changed.wait(lock, [&] { return stopping || !pending_images.empty(); });
+      if (pending_images.empty()) {
+        return;
+      }
+
+      image = std::move(pending_images.front());
+      pending_images.pop_front();
+      is_writing = true;
+    }
+    queue_changed.notify_all();
+
+    bool is_written = Write(image.file_name.c_str(), image.width, image.height, image.pixels.data(), compression,
+                            rows_per_strip, &encoder_pool);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      has_failed = has_failed || !is_written;
+      is_writing = false;
+    }
+    queue_changed.notify_all();
+  }
+}
+
+// Strips are encoded independently, so they can be compressed in parallel; only the file writes are sequential.
+auto ImageWriter::Write(const char *file_name, int width, int height, const unsigned int *pixels,
+                        Compression compression, int rows_per_strip, ThreadPool *thread_pool) -> bool {
+  Profiler::ScopedTimer timer(Profiler::SAVE_TIFF);
+  TIFF *output = TIFFOpen(file_name, "w");
+  if (output == nullptr) {
+    std::cerr << file_name << " could not be opened" << '\n';
+    return false;
+  }
+
+  constexpr int SAMPLES_PER_PIXEL = 4;
+  constexpr int BITS_PER_CHANNEL = 8;
+  rows_per_strip = std::clamp(rows_per_strip, 1, std::max(height, 1));
+  TIFFSetField(output, TIFFTAG_IMAGEWIDTH, width);
+  TIFFSetField(output, TIFFTAG_IMAGELENGTH, height);
+  TIFFSetField(output, TIFFTAG_SAMPLESPERPIXEL, SAMPLES_PER_PIXEL);
+  TIFFSetField(output, TIFFTAG_BITSPERSAMPLE, BITS_PER_CHANNEL);
+  TIFFSetField(output, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+  TIFFSetField(output, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+  TIFFSetField(output, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+  TIFFSetField(output, TIFFTAG_COMPRESSION, GetTiffCompression(compression));
+  TIFFSetField(output, TIFFTAG_ROWSPERSTRIP, rows_per_strip);
+
+  int strip_count = (height + rows_per_strip - 1) / rows_per_strip;
+  std::vector<std::vector<std::uint8_t>> encoded_strips(strip_count);
+  std::vector<unsigned char> is_encoded(strip_count, 0);
+  auto encode_strip = [&](int strip_index) {
+    thread_local std::vector<std::uint8_t> raw;
+    int first_row = strip_index * rows_per_strip;
+    GatherStrip(width, height, pixels, first_row, std::min(rows_per_strip, height - first_row), raw);
+    is_encoded[strip_index] = EncodeStrip(raw, compression, encoded_strips[strip_index]) ? 1 : 0;
+  };
+  if (thread_pool != nullptr) {
+    thread_pool->ParallelFor(strip_count, encode_strip);
+  } else {
+    for (int strip_index = 0; strip_index < strip_count; strip_index++) {
+      encode_strip(strip_index);
+    }
+  }
+
+  bool is_written = true;
+  for (int strip_index = 0; strip_index < strip_count && is_written; strip_index++) {
+    std::vector<std::uint8_t> &strip = encoded_strips[strip_index];
+    is_written = is_encoded[strip_index] != 0 &&
+                 TIFFWriteRawStrip(output, strip_index, strip.data(), static_cast<tmsize_t>(strip.size())) >= 0;
+  }
+  TIFFClose(output);
+
+  if (!is_written) {
+    std::cerr << file_name << " could not be written" << '\n';
+  }
+  return is_written;
+}
@@ -0,0 +1,106 @@
+#include "graphics_pipeline/line_setup.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+auto FloorDivide(std::int64_t numerator, std::int64_t denominator) -> std::int64_t {
+  std::int64_t quotient = numerator / denominator;
+  return (numerator % denominator != 0 && numerator < 0) ? quotient - 1 : quotient;
+}
+
+auto CeilDivide(std::int64_t numerator, std::int64_t denominator) -> std::int64_t {
+  std::int64_t quotient = numerator / denominator;
+  return (numerator % denominator != 0 && numerator > 0) ? quotient + 1 : quotient;
+}
+
+// Liang-Barsky against one pair of bounds, narrowing [enter, exit].
+auto ClipAxis(float start, float delta, float lowest, float highest, float &enter, float &exit) -> bool {
+  if (delta == 0.0F) {
+    return start >= lowest && start <= highest;
+  }
+
+  float lowest_time = (lowest - start) / delta;
+  float highest_time = (highest - start) / delta;
+  enter = std::max(enter, std::min(lowest_time, highest_time));
+  exit = std::min(exit, std::max(lowest_time, highest_time));
+  return enter <= exit;
+}
+
+// Narrows [first, last] to the steps whose major coordinate start + sign * step lies in [lowest, highest].
+void ClipMajor(std::int64_t start, int sign, std::int64_t lowest, std::int64_t highest, std::int64_t &first,
+               std::int64_t &last) {
+  first = std::max(first, sign > 0 ? lowest - start : start - highest);
+  last = std::min(last, sign > 0 ? highest - start : start - lowest);
+}
+
+// Narrows [first, last] to the steps whose minor offset floor((2 * step * minor + major) / (2 * major)) keeps the
+// minor coordinate start + sign * offset in [lowest, highest].
+void ClipMinor(std::int64_t start, int sign, std::int64_t major_delta, std::int64_t minor_delta,
+               std::int64_t lowest, std::int64_t highest, std::int64_t &first, std::int64_t &last) {
+  std::int64_t lowest_offset = sign > 0 ? lowest - start : start - highest;
+  std::int64_t highest_offset = sign > 0 ? highest - start : start - lowest;
+  if (minor_delta == 0) {
+    if (lowest_offset > 0 || highest_offset < 0) {
+      last = first - 1;
+    }
+    return;
+  }
+
+  first = std::max(first, CeilDivide((2 * major_delta * lowest_offset) - major_delta, 2 * minor_delta));
+  last = std::min(last, FloorDivide((2 * major_delta * (highest_offset + 1)) - major_delta - 1, 2 * minor_delta));
+}
+} // namespace
+
+auto LineSetup::Initialize(Vector3 start_point, Vector3 end_point, ClipRectangle clip) -> bool {
+  if (!std::isfinite(start_point[0]) || !std::isfinite(start_point[1]) || !std::isfinite(end_point[0]) ||
+      !std::isfinite(end_point[1])) {
+    return false;
+  }
+
+  float lowest_u = static_cast<float>(clip.min_u) - GUARD_BAND;
+  float highest_u = static_cast<float>(clip.max_u + 1) + GUARD_BAND;
+  float lowest_v = static_cast<float>(clip.min_v) - GUARD_BAND;
+  float highest_v = static_cast<float>(clip.max_v + 1) + GUARD_BAND;
+  float delta_u = end_point[0] - start_point[0];
+  float delta_v = end_point[1] - start_point[1];
+
+  float enter = 0.0F;
+  float exit = 1.0F;
+  if (!ClipAxis(start_point[0], delta_u, lowest_u, highest_u, enter, exit) ||
+      !ClipAxis(start_point[1], delta_v, lowest_v, highest_v, enter, exit)) {
+    return false;
+  }
+
+  std::int64_t end_u = static_cast<std::int64_t>(floorf(start_point[0] + (delta_u * exit)));
+  std::int64_t end_v = static_cast<std::int64_t>(floorf(start_point[1] + (delta_v * exit)));
+  start_u = static_cast<std::int64_t>(floorf(start_point[0] + (delta_u * enter)));
+  start_v = static_cast<std::int64_t>(floorf(start_point[1] + (delta_v * enter)));
+
+  std::int64_t span_u = end_u - start_u;
+  std::int64_t span_v = end_v - start_v;
+  is_u_major = std::abs(span_u) >= std::abs(span_v);
+  major_delta = std::abs(is_u_major ? span_u : span_v);
+  minor_delta = std::abs(is_u_major ? span_v : span_u);
+  major_sign = (is_u_major ? span_u : span_v) < 0 ? -1 : 1;
+  minor_sign = (is_u_major ? span_v : span_u) < 0 ? -1 : 1;
+
+  parameter_origin = enter;
+  parameter_scale = major_delta > 0 ? (exit - enter) / static_cast<float>(major_delta) : 0.0F;
+
+  first_step = 0;
+  last_step = major_delta;
+  if (is_u_major) {
+    ClipMajor(start_u, major_sign, clip.min_u, clip.max_u, first_step, last_step);
+    ClipMinor(start_v, minor_sign, major_delta, minor_delta, clip.min_v, clip.max_v, first_step, last_step);
+  } else {
+    ClipMajor(start_v, major_sign, clip.min_v, clip.max_v, first_step, last_step);
+    ClipMinor(start_u, minor_sign, major_delta, minor_delta, clip.min_u, clip.max_u, first_step, last_step);
+  }
+
+  return first_step <= last_step;
+}
+
+auto LineSetup::GetParameter(std::int64_t step) const -> float {
+  return parameter_origin + (parameter_scale * static_cast<float>(step));
+}
@@ -0,0 +1,185 @@
+#include "graphics_pipeline/profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+namespace {
+constexpr double NANOSECONDS_PER_MILLISECOND = 1e6;
+constexpr double NANOSECONDS_PER_MICROSECOND = 1e3;
+constexpr int CACHE_LINE_SIZE = 64;
+
+struct TraceEvent {
+  Profiler::Stage stage;
+  std::int64_t start_time;
+  std::int64_t duration;
+};
+
+// Each thread adds to its own slot, and readers tolerate values that are one update stale. The trace mutex is
+// uncontended except while a trace is saved.
+struct alignas(CACHE_LINE_SIZE) ThreadSlot {
+  std::array<std::atomic<std::int64_t>, Profiler::STAGE_COUNT> stage_times{};
+  std::array<std::atomic<long>, Profiler::COUNTER_COUNT> counters{};
+  std::mutex trace_mutex;
+  std::vector<TraceEvent> trace_events;
+};
+
+std::array<ThreadSlot, Profiler::MAX_THREAD_SLOTS> thread_slots;
+std::atomic<int> next_slot_index(0);
+std::atomic<bool> is_enabled(false);
+std::atomic<bool> is_tracing(false);
+std::atomic<std::int64_t> trace_start_time(0);
+
+// Frame bookkeeping belongs to the thread calling EndFrame; the mutex lets other threads read the history.
+std::mutex history_mutex;
+std::deque<Profiler::FrameStats> frame_history;
+std::array<std::int64_t, Profiler::STAGE_COUNT> previous_stage_totals{};
+std::array<long, Profiler::COUNTER_COUNT> previous_counter_totals{};
+std::int64_t previous_frame_end = 0;
+
+auto GetTime() -> std::int64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+auto GetSlotIndex() -> int {
+  thread_local int slot_index = next_slot_index.fetch_add(1, std::memory_order_relaxed) % Profiler::MAX_THREAD_SLOTS;
+  return slot_index;
+}
+} // namespace
+
+Profiler::ScopedTimer::ScopedTimer(Stage _stage) {
+  stage = _stage;
+  is_active = is_enabled.load(std::memory_order_relaxed);
+  start_time = is_active ? GetTime() : 0;
+}
+
+Profiler::ScopedTimer::~ScopedTimer() { Stop(); }
+
+void Profiler::ScopedTimer::Stop() {
+  if (!is_active) {
+    return;
+  }
+
+  is_active = false;
+  std::int64_t duration = GetTime() - start_time;
+  ThreadSlot &slot = thread_slots[GetSlotIndex()];
+  slot.stage_times[stage].fetch_add(duration, std::memory_order_relaxed);
+  if (is_tracing.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(slot.trace_mutex);
+    slot.trace_events.push_back({stage, start_time, duration});
+  }
+}
+
+void Profiler::SetEnabled(bool enabled) { is_enabled.store(enabled, std::memory_order_relaxed); }
+
+auto Profiler::IsEnabled() -> bool { return is_enabled.load(std::memory_order_relaxed); }
+
+void Profiler::AddCount(Counter counter, long count) {
+  if (!is_enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  thread_slots[GetSlotIndex()].counters[counter].fetch_add(count, std::memory_order_relaxed);
+}
+
+// Slots are never reset, so a frame's values are the growth of the totals since the previous frame ended.
+void Profiler::EndFrame() {
+  std::int64_t frame_end = GetTime();
+  std::array<std::int64_t, STAGE_COUNT> stage_totals{};
+  std::array<long, COUNTER_COUNT> counter_totals{};
+  for (const auto &slot : thread_slots) {
+    for (int i = 0; i < STAGE_COUNT; i++) {
+      stage_totals[i] += slot.stage_times[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+      counter_totals[i] += slot.counters[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  FrameStats frame;
+  frame.frame_time = previous_frame_end == 0
+                         ? 0.0
+                         : static_cast<double>(frame_end - previous_frame_end) / NANOSECONDS_PER_MILLISECOND;
+  for (int i = 0; i < STAGE_COUNT; i++) {
+    frame.stage_times[i] =
+        static_cast<double>(stage_totals[i] - previous_stage_totals[i]) / NANOSECONDS_PER_MILLISECOND;
+  }
+  for (int i = 0; i < COUNTER_COUNT; i++) {
+    frame.counters[i] = counter_totals[i] - previous_counter_totals[i];
+  }
+  previous_stage_totals = stage_totals;
+  previous_counter_totals = counter_totals;
+  previous_frame_end = frame_end;
+
+  std::lock_guard<std::mutex> lock(history_mutex);
+  frame_history.push_back(frame);
+  if (static_cast<int>(frame_history.size()) > FRAME_HISTORY_LENGTH) {
+    frame_history.pop_front();
+  }
+}
+
+auto Profiler::GetFrameHistory() -> std::vector<FrameStats> {
+  std::lock_guard<std::mutex> lock(history_mutex);
+  return {frame_history.begin(), frame_history.end()};
+}
+
+void Profiler::StartTrace() {
+  for (auto &slot : thread_slots) {
+    std::lock_guard<std::mutex> lock(slot.trace_mutex);
+    slot.trace_events.clear();
+  }
+  trace_start_time.store(GetTime(), std::memory_order_relaxed);
+  is_tracing.store(true, std::memory_order_relaxed);
+}
+
+auto Profiler::IsTracing() -> bool { return is_tracing.load(std::memory_order_relaxed); }
+
+// Complete ("X") events with microsecond timestamps, one trace row per thread slot.
+auto Profiler::SaveTrace(const char *file_name) -> bool {
+  is_tracing.store(false, std::memory_order_relaxed);
+
+  std::ofstream output(file_name);
+  if (!output.is_open()) {
+    std::cerr << file_name << " could not be opened" << '\n';
+    return false;
+  }
+
+  std::int64_t start_time = trace_start_time.load(std::memory_order_relaxed);
+  bool is_first_event = true;
+  // The default six significant digits would merge events a few microseconds apart once a trace is a second long.
+  output << std::fixed << std::setprecision(3);
+  output << "{\"traceEvents\":[";
+  for (int slot_index = 0; slot_index < MAX_THREAD_SLOTS; slot_index++) {
+    ThreadSlot &slot = thread_slots[slot_index];
+    std::lock_guard<std::mutex> lock(slot.trace_mutex);
+    for (const auto &event : slot.trace_events) {
+      output << (is_first_event ? "" : ",") << '\n'
+             << R"({"name":")" << GetStageName(event.stage) << R"(","cat":"pipeline","ph":"X","pid":0,"tid":)"
+             << slot_index << R"(,"ts":)"
+             << static_cast<double>(event.start_time - start_time) / NANOSECONDS_PER_MICROSECOND << R"(,"dur":)"
+             << static_cast<double>(event.duration) / NANOSECONDS_PER_MICROSECOND << "}";
+      is_first_event = false;
+    }
+    slot.trace_events.clear();
+  }
+  output << '\n' << "]}" << '\n';
+  return true;
+}
+
+auto Profiler::GetStageName(Stage stage) -> const char * {
+  constexpr std::array<const char *, STAGE_COUNT> NAMES = {
+      "DrawMeshFilled", "Projection", "Culling", "Rasterization", "Rasterization tile", "Shading", "Present",
+      "SaveTiff"};
+  return NAMES[stage];
+}
+
+auto Profiler::GetCounterName(Counter counter) -> const char * {
+  constexpr std::array<const char *, COUNTER_COUNT> NAMES = {"Triangles in",     "Triangles culled",
+                                                             "Triangles rasterized", "Screen triangles",
+                                                             "Pixels tested",    "Pixels written"};
+  return NAMES[counter];
+}
@@ -1,51 +1,41 @@
 #include "graphics_pipeline/scene.h"
 
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
-
-#include <iostream>
+#include <algorithm>
+#include <thread>
 
 #include "graphics_pipeline/color.h"
+#include "graphics_pipeline/profiler.h"
+#include "graphics_pipeline/span_kernels.h"
 #include "graphics_pipeline/triangle_mesh.h"
 #include "graphics_pipeline/vector_3.h"
 
-Scene *scene;
-constexpr int framebuffer_width = 640;
-constexpr int framebuffer_height = 480;
-constexpr int gui_width = 400;
-constexpr int gui_height = 300;
-
-Scene::Scene() {
-  gui = new GUI(gui_width, gui_height, "GUI");
-  framebuffer = new Framebuffer(framebuffer_width, framebuffer_height, "SW Framebuffer");
-  camera = new PlanarPinholeCamera(framebuffer_width, framebuffer_height, 1.0F);
-
-  glfwSetWindowUserPointer(framebuffer->window, this);
-  glfwSetKeyCallback(framebuffer->window, KeyCallback);
-  glfwSetMouseButtonCallback(framebuffer->window, MouseButtonCallback);
-  glfwSetCursorPosCallback(framebuffer->window, CursorPositionCallback);
-  glfwSetScrollCallback(framebuffer->window, ScrollCallback);
+constexpr float DEFAULT_AMBIENT_COEFFICIENT = 0.2F;
+constexpr float DEFAULT_SPECULAR_EXPONENT = 32.0F;
+constexpr float DEFAULT_NEAR_PLANE_DISTANCE = 0.1F;
+constexpr float SHADOW_EPSILON = 1e-3F;
+// Visibility buffer entries hold a projected triangle index plus one, so 0 marks a pixel no triangle covered.
+constexpr unsigned int EMPTY_VISIBILITY = 0;
+
+Scene::Scene(int _width, int _height)
+    : Scene(_width, _height, static_cast<int>(std::max(std::thread::hardware_concurrency(), 1U))) {}
+
+Scene::Scene(int _width, int _height, int thread_count) {
+  framebuffer = new Framebuffer(_width, _height);
+  camera = new PlanarPinholeCamera(_width, _height, 1.0F);
+  thread_pool = new ThreadPool(thread_count);
+  shadow_map = nullptr;
+  lights.emplace_back();
+  ambient_coefficient = DEFAULT_AMBIENT_COEFFICIENT;
+  specular_exponent = DEFAULT_SPECULAR_EXPONENT;
+  near_plane_distance = DEFAULT_NEAR_PLANE_DISTANCE;
+  use_tiled_rasterization = true;
+  use_visibility_buffer = false;
 }
 
 Scene::~Scene() {
+  delete thread_pool;
   delete camera;
   delete framebuffer;
-  delete gui;
-}
-
-void Scene::Run() {
-  while ((glfwWindowShouldClose(framebuffer->window) == 0) && (glfwWindowShouldClose(gui->window) == 0)) {
-    glfwMakeContextCurrent(gui->window);
-    glClear(GL_COLOR_BUFFER_BIT);
-    gui->Render();
-    glfwSwapBuffers(gui->window);
-
-    glfwMakeContextCurrent(framebuffer->window);
-    glClear(GL_COLOR_BUFFER_BIT);
-    framebuffer->Render();
-
-    glfwPollEvents();
-  }
 }
 
 void Scene::Draw3DPoint(Vector3 point, int size, unsigned int color) {
@@ -57,8 +47,8 @@ void Scene::Draw3DPoint(Vector3 point, int size, unsigned int color) {
 
   float focal_length = camera->GetFocalLength();
 
-  float u_coordinate = ((float)camera->width / (float)2) + (projected_point[0] * focal_length);
-  float v_coordinate = ((float)camera->height / (float)2) - (projected_point[1] * focal_length);
+  float u_coordinate = ((float)camera->GetWidth() / (float)2) + (projected_point[0] * focal_length);
+  float v_coordinate = ((float)camera->GetHeight() / (float)2) - (projected_point[1] * focal_length);
 
   Vector3 screen_point(u_coordinate, v_coordinate, 0.0F);
   framebuffer->DrawPoint(screen_point, size, color);
@@ -78,11 +68,11 @@ void Scene::Draw3DSegment(Vector3 start_point, Vector3 end_point, unsigned int c
 
   float focal_length = camera->GetFocalLength();
 
-  float u_start = ((float)camera->width / (float)2) + (projected_start_point[0] * focal_length);
-  float v_start = ((float)camera->height / (float)2) - (projected_start_point[1] * focal_length);
+  float u_start = ((float)camera->GetWidth() / (float)2) + (projected_start_point[0] * focal_length);
+  float v_start = ((float)camera->GetHeight() / (float)2) - (projected_start_point[1] * focal_length);
 
-  float u_end = ((float)camera->width / (float)2) + (projected_end_point[0] * focal_length);
-  float v_end = ((float)camera->height / (float)2) - (projected_end_point[1] * focal_length);
+  float u_end = ((float)camera->GetWidth() / (float)2) + (projected_end_point[0] * focal_length);
+  float v_end = ((float)camera->GetHeight() / (float)2) - (projected_end_point[1] * focal_length);
 
   Vector3 screen_start(u_start, v_start, 0.0F);
   Vector3 screen_end(u_end, v_end, 0.0F);
@@ -103,11 +93,11 @@ void Scene::Draw3DSegment(Vector3 start_point, Vector3 end_point, Vector3 start_
 
   float focal_length = camera->GetFocalLength();
 
-  float u_start = ((float)camera->width / (float)2) + (projected_start_point[0] * focal_length);
-  float v_start = ((float)camera->height / (float)2) - (projected_start_point[1] * focal_length);
+  float u_start = ((float)camera->GetWidth() / (float)2) + (projected_start_point[0] * focal_length);
+  float v_start = ((float)camera->GetHeight() / (float)2) - (projected_start_point[1] * focal_length);
 
-  float u_end = ((float)camera->width / (float)2) + (projected_end_point[0] * focal_length);
-  float v_end = ((float)camera->height / (float)2) - (projected_end_point[1] * focal_length);
+  float u_end = ((float)camera->GetWidth() / (float)2) + (projected_end_point[0] * focal_length);
+  float v_end = ((float)camera->GetHeight() / (float)2) - (projected_end_point[1] * focal_length);
 
   Vector3 screen_start(u_start, v_start, 0.0F);
   Vector3 screen_end(u_end, v_end, 0.0F);
@@ -115,27 +105,45 @@ void Scene::Draw3DSegment(Vector3 start_point, Vector3 end_point, Vector3 start_
 }
 
 void Scene::DrawMeshPoints(TriangleMesh *mesh, int size, unsigned int color) {
-  for (auto vertex : mesh->vertices) {
-    Draw3DPoint(vertex, size, color);
+  camera->ProjectPoints(mesh->vertices, screen_vertices, is_vertex_projected);
+  for (int i = 0; i < static_cast<int>(screen_vertices.size()); i++) {
+    if (is_vertex_projected[i] != 0) {
+      framebuffer->DrawPoint(screen_vertices[i], size, color);
+    }
   }
 }
 
+// Vertices are projected once and every unique edge is drawn once. With facing culling enabled, an edge is skipped
+// only when all the triangles it borders are culled.
 void Scene::DrawMeshWireframe(TriangleMesh *mesh, unsigned int color) {
-  for (int i = 0; i < (int)mesh->triangles.size() / 3; i++) {
-    std::array<Vector3, 3> vertices;
-    std::array<unsigned int, 3> indices;
-
-    indices[0] = mesh->triangles[(i * 3) + 0];
-    indices[1] = mesh->triangles[(i * 3) + 1];
-    indices[2] = mesh->triangles[(i * 3) + 2];
+  const std::vector<TriangleMesh::Edge> &edges = mesh->GetEdges();
+
+  camera->ProjectPoints(mesh->vertices, screen_vertices, is_vertex_projected);
+
+  bool use_culling = culler.cull_mode != Culler::CULL_NONE;
+  if (use_culling) {
+    is_triangle_culled.resize(mesh->triangles.size() / 3);
+    for (int i = 0; i < static_cast<int>(is_triangle_culled.size()); i++) {
+      std::array<unsigned int, 3> indices = {mesh->triangles[(i * 3) + 0], mesh->triangles[(i * 3) + 1],
+                                             mesh->triangles[(i * 3) + 2]};
+      is_triangle_culled[i] = is_vertex_projected[indices[0]] != 0 && is_vertex_projected[indices[1]] != 0 &&
+                              is_vertex_projected[indices[2]] != 0 &&
+                              culler.IsFacingCulled(screen_vertices[indices[0]], screen_vertices[indices[1]],
+                                                    screen_vertices[indices[2]]);
+    }
+  }
 
-    vertices[0] = mesh->vertices[indices[0]];
-    vertices[1] = mesh->vertices[indices[1]];
-    vertices[2] = mesh->vertices[indices[2]];
+  for (const auto &edge : edges) {
+    if (is_vertex_projected[edge.vertices[0]] == 0 || is_vertex_projected[edge.vertices[1]] == 0) {
+      continue;
+    }
 
-    for (int j = 0; j < 3; j++) {
-      Draw3DSegment(vertices[j], vertices[(j + 1) % 3], color);
+    if (use_culling && edge.triangles[0] != TriangleMesh::NO_TRIANGLE && is_triangle_culled[edge.triangles[0]] &&
+        (edge.triangles[1] == TriangleMesh::NO_TRIANGLE || is_triangle_culled[edge.triangles[1]])) {
+      continue;
     }
+
+    framebuffer->DrawSegment(screen_vertices[edge.vertices[0]], screen_vertices[edge.vertices[1]], color);
   }
 }
 
@@ -151,21 +159,40 @@ void Scene::DrawMeshNormals(TriangleMesh *mesh, int size) {
 }
 
 void Scene::DrawMeshFilled(TriangleMesh *mesh, bool use_lighting) {
-  framebuffer->z_buffer.resize(static_cast<long>(framebuffer->width) * framebuffer->height);
+  Profiler::ScopedTimer timer(Profiler::DRAW_MESH_FILLED);
+  // Depths are 1/z and the clipper keeps every point beyond the near plane, so 1/near bounds them.
+  framebuffer->depth_range = 1.0F / near_plane_distance;
+  framebuffer->AllocateZBuffer();
   framebuffer->ClearZBuffer();
+  if (use_visibility_buffer) {
+    framebuffer->visibility_buffer.assign(framebuffer->GetStorageSize(), EMPTY_VISIBILITY);
+  }
+  projected_triangles.clear();
+  culler.ResetCounters();
 
-  for (int i = 0; i < static_cast<int>(mesh->triangles.size()) / 3; i++) {
+  float focal_length = camera->GetFocalLength();
+  float half_width = static_cast<float>(camera->GetWidth()) / 2.0F;
+  float half_height = static_cast<float>(camera->GetHeight()) / 2.0F;
+  clipper.SetFrustum(focal_length, camera->GetWidth(), camera->GetHeight(), near_plane_distance);
+
+  int triangle_count = static_cast<int>(mesh->triangles.size()) / 3;
+  Profiler::ScopedTimer projection_timer(Profiler::PROJECTION);
+  ProcessVertices(mesh, focal_length);
+  for (int i = 0; i < triangle_count; i++) {
     std::array<unsigned int, 3> indices;
-    std::array<Vector3, 3> vertices;
+    std::array<std::uint16_t, 3> clip_flags;
     std::array<Vector3, 3> colors;
 
     indices[0] = mesh->triangles[(i * 3) + 0];
     indices[1] = mesh->triangles[(i * 3) + 1];
     indices[2] = mesh->triangles[(i * 3) + 2];
 
-    vertices[0] = mesh->vertices[indices[0]];
-    vertices[1] = mesh->vertices[indices[1]];
-    vertices[2] = mesh->vertices[indices[2]];
+    clip_flags[0] = vertex_clip_flags[indices[0]];
+    clip_flags[1] = vertex_clip_flags[indices[1]];
+    clip_flags[2] = vertex_clip_flags[indices[2]];
+    if ((clip_flags[0] & clip_flags[1] & clip_flags[2] & Clipper::VIEWPORT_FLAGS) != 0) {
+      continue;
+    }
 
     if (use_lighting && !mesh->colors.empty()) {
       colors[0] = mesh->colors[indices[0]];
@@ -177,176 +204,275 @@ void Scene::DrawMeshFilled(TriangleMesh *mesh, bool use_lighting) {
       colors[2] = Vector3(1.0F, 1.0F, 1.0F);
     }
 
-    std::array<Vector3, 3> projected_points;
-    std::array<float, 3> depths;
-    bool all_visible = true;
+    // Triangles within the guard band keep the vertices projected by ProcessVertices.
+    if (((clip_flags[0] | clip_flags[1] | clip_flags[2]) & Clipper::GUARD_BAND_FLAGS) == 0) {
+      ProjectedTriangle triangle;
+      for (int k = 0; k < 3; k++) {
+        Vector3 screen_vertex = screen_vertices[indices[k]];
+        triangle.screen_points[k] = Vector3(screen_vertex[0], screen_vertex[1], 0.0F);
+        triangle.colors[k] = colors[k];
+        triangle.depths[k] = screen_vertex[2];
+        triangle.source_weights[k] = Vector3(k == 0 ? 1.0F : 0.0F, k == 1 ? 1.0F : 0.0F, k == 2 ? 1.0F : 0.0F);
+      }
+      triangle.mesh_triangle_index = i;
+      projected_triangles.push_back(triangle);
+      continue;
+    }
 
+    std::array<Clipper::Vertex, 3> clip_vertices;
     for (int j = 0; j < 3; j++) {
-      if (camera->Project(vertices[j], projected_points[j]) == 0) {
-        all_visible = false;
-        break;
-      }
-      depths[j] = projected_points[j][2];
+      clip_vertices[j].camera_point = camera_vertices[indices[j]];
+      clip_vertices[j].color = colors[j];
+      clip_vertices[j].source_weights = Vector3(j == 0 ? 1.0F : 0.0F, j == 1 ? 1.0F : 0.0F, j == 2 ? 1.0F : 0.0F);
     }
 
-    if (!all_visible) {
+    Clipper::Polygon polygon;
+    if (clipper.ClipTriangle(clip_vertices, clip_flags, polygon) == Clipper::REJECTED) {
       continue;
     }
 
-    float focal_length = camera->GetFocalLength();
-
-    std::array<Vector3, 3> screen_points;
-    for (int j = 0; j < 3; j++) {
-      float u_coordinate = (static_cast<float>(camera->width) / (float)2) + (projected_points[j][0] * focal_length);
-      float v_coordinate = (static_cast<float>(camera->height) / (float)2) - (projected_points[j][1] * focal_length);
+    std::array<Vector3, Clipper::MAX_POLYGON_VERTICES> screen_points;
+    std::array<float, Clipper::MAX_POLYGON_VERTICES> depths;
+    for (int j = 0; j < polygon.vertex_count; j++) {
+      Vector3 camera_point = polygon.vertices[j].camera_point;
+      depths[j] = 1.0F / camera_point[2];
+      float u_coordinate = half_width + ((camera_point[0] / camera_point[2]) * focal_length);
+      float v_coordinate = half_height - ((camera_point[1] / camera_point[2]) * focal_length);
       screen_points[j] = Vector3(u_coordinate, v_coordinate, 0.0F);
     }
 
-    framebuffer->DrawTriangleFilled(screen_points[0], screen_points[1], screen_points[2], colors[0], colors[1],
-                                    colors[2], depths[0], depths[1], depths[2]);
+    for (int j = 1; j + 1 < polygon.vertex_count; j++) {
+      ProjectedTriangle triangle;
+      std::array<int, 3> corners = {0, j, j + 1};
+      for (int k = 0; k < 3; k++) {
+        triangle.screen_points[k] = screen_points[corners[k]];
+        triangle.colors[k] = polygon.vertices[corners[k]].color;
+        triangle.depths[k] = depths[corners[k]];
+        triangle.source_weights[k] = polygon.vertices[corners[k]].source_weights;
+      }
+      triangle.mesh_triangle_index = i;
+      projected_triangles.push_back(triangle);
+    }
   }
-}
-
-void Scene::KeyCallback(GLFWwindow *window, int key, int scan_code, int action, int mods) {
-  auto *scene = static_cast<Scene *>(glfwGetWindowUserPointer(window));
-  if (scene != nullptr) {
-    scene->HandleKeyInput(key, action, mods);
+  projection_timer.Stop();
+
+  CullProjectedTriangles();
+  // Mesh triangles are either culled or rasterized, whichever part of the pipeline removed them; a triangle counts
+  // as rasterized when any triangle of its clipped fan survives. Fan triangles of one mesh triangle are adjacent.
+  long rasterized_count = 0;
+  for (std::size_t i = 0; i < projected_triangles.size(); i++) {
+    if (i == 0 || projected_triangles[i].mesh_triangle_index != projected_triangles[i - 1].mesh_triangle_index) {
+      rasterized_count++;
+    }
+  }
+  Profiler::AddCount(Profiler::TRIANGLES_IN, triangle_count);
+  Profiler::AddCount(Profiler::TRIANGLES_CULLED, triangle_count - rasterized_count);
+  Profiler::AddCount(Profiler::TRIANGLES_RASTERIZED, rasterized_count);
+  Profiler::AddCount(Profiler::SCREEN_TRIANGLES, static_cast<long>(projected_triangles.size()));
+
+  {
+    Profiler::ScopedTimer rasterization_timer(Profiler::RASTERIZATION);
+    if (use_tiled_rasterization && thread_pool->GetThreadCount() > 1) {
+      DrawProjectedTrianglesTiled(mesh, use_lighting);
+    } else {
+      DrawProjectedTriangles(mesh, use_lighting);
+    }
   }
-}
 
-void Scene::MouseButtonCallback(GLFWwindow *window, int button, int action, int mods) {
-  auto *scene = static_cast<Scene *>(glfwGetWindowUserPointer(window));
-  if (scene != nullptr) {
-    scene->HandleMouseButton(button, action, mods);
+  if (use_visibility_buffer) {
+    Profiler::ScopedTimer shading_timer(Profiler::SHADING);
+    ShadeVisibilityBuffer(mesh, use_lighting);
   }
 }
 
-void Scene::CursorPositionCallback(GLFWwindow *window, double u_coordinate, double v_coordinate) {
-  auto *scene = static_cast<Scene *>(glfwGetWindowUserPointer(window));
-  if (scene != nullptr) {
-    scene->HandleCursorPosition(u_coordinate, v_coordinate);
+// Transforms, classifies and projects every vertex once, however many triangles share it. The projection is only
+// meaningful for vertices beyond the near plane; triangles with other vertices go through the clipper.
+void Scene::ProcessVertices(TriangleMesh *mesh, float focal_length) {
+  camera->TransformPoints(mesh->vertices, camera_vertices);
+  float half_width = static_cast<float>(camera->GetWidth()) / 2.0F;
+  float half_height = static_cast<float>(camera->GetHeight()) / 2.0F;
+  auto vertex_count = static_cast<int>(camera_vertices.size());
+  screen_vertices.resize(vertex_count);
+  vertex_clip_flags.resize(vertex_count);
+  for (int i = 0; i < vertex_count; i++) {
+    const std::array<float, 3> &camera_point = camera_vertices[i].coordinates;
+    vertex_clip_flags[i] = clipper.GetClipFlags(camera_vertices[i]);
+    screen_vertices[i].coordinates = {half_width + ((camera_point[0] / camera_point[2]) * focal_length),
+                                      half_height - ((camera_point[1] / camera_point[2]) * focal_length),
+                                      1.0F / camera_point[2]};
   }
 }
 
-void Scene::ScrollCallback(GLFWwindow *window, double u_offset, double v_offset) {
-  auto *scene = static_cast<Scene *>(glfwGetWindowUserPointer(window));
-  if (scene != nullptr) {
-    scene->HandleScroll(u_offset, v_offset);
-  }
+// Removes the triangles the culler rejects, keeping the others in draw order.
+void Scene::CullProjectedTriangles() {
+  Profiler::ScopedTimer timer(Profiler::CULLING);
+  auto culled = std::ranges::remove_if(projected_triangles, [&](const ProjectedTriangle &triangle) {
+    return culler.Test(triangle.screen_points[0], triangle.screen_points[1], triangle.screen_points[2]) !=
+           Culler::VISIBLE;
+  });
+  projected_triangles.erase(culled.begin(), culled.end());
 }
 
-void Scene::HandleKeyInput(int key, int action, int mods) {
-  if (action != GLFW_PRESS && action != GLFW_REPEAT) {
+// In visibility buffer mode triangles only write depth and their index; shading happens afterwards, once per pixel.
+// Otherwise triangles that need textures or lighting go through MeshShader, and the rest through the color kernels.
+void Scene::DrawProjectedTriangle(TriangleMesh *mesh, bool use_lighting, int triangle_index, ClipRectangle clip) {
+  auto &triangle = projected_triangles[triangle_index];
+  if (use_visibility_buffer) {
+    framebuffer->DrawTriangleVisibility(triangle.screen_points[0], triangle.screen_points[1],
+                                        triangle.screen_points[2], triangle.depths[0], triangle.depths[1],
+                                        triangle.depths[2], static_cast<unsigned int>(triangle_index) + 1, clip);
     return;
   }
 
-  constexpr float TRANSLATION_STEP = 1.0F;
-  constexpr float ROTATION_STEP = 0.1F;
-  constexpr float ZOOM_FACTOR = 1.1F;
-
-  switch (key) {
-  case GLFW_KEY_W:
-    camera->Translate(camera->forward * TRANSLATION_STEP);
-    break;
-  case GLFW_KEY_S:
-    camera->Translate(camera->forward * (-TRANSLATION_STEP));
-    break;
-  case GLFW_KEY_A:
-    camera->Translate(camera->right * (-TRANSLATION_STEP));
-    break;
-  case GLFW_KEY_D:
-    camera->Translate(camera->right * TRANSLATION_STEP);
-    break;
-  case GLFW_KEY_Q:
-    camera->Translate(camera->up * (-TRANSLATION_STEP));
-    break;
-  case GLFW_KEY_E:
-    camera->Translate(camera->up * TRANSLATION_STEP);
-    break;
-  case GLFW_KEY_UP:
-    camera->Tilt(-ROTATION_STEP);
-    break;
-  case GLFW_KEY_DOWN:
-    camera->Tilt(ROTATION_STEP);
-    break;
-  case GLFW_KEY_LEFT:
-    camera->Pan(ROTATION_STEP);
-    break;
-  case GLFW_KEY_RIGHT:
-    camera->Pan(-ROTATION_STEP);
-    break;
-  case GLFW_KEY_Z:
-    camera->Roll(-ROTATION_STEP);
-    break;
-  case GLFW_KEY_X:
-    camera->Roll(ROTATION_STEP);
-    break;
-  case GLFW_KEY_EQUAL:
-    camera->Zoom(ZOOM_FACTOR);
-    break;
-  case GLFW_KEY_MINUS:
-    camera->Zoom(1.0F / ZOOM_FACTOR);
-    break;
-  default:
-    break;
+  if (IsFragmentShaded(mesh, use_lighting)) {
+    MeshShader shader{this, mesh, {}, use_lighting};
+    std::array<MeshShader::Varyings, 3> varyings;
+    for (int k = 0; k < 3; k++) {
+      shader.indices[k] = mesh->triangles[(triangle.mesh_triangle_index * 3) + k];
+      varyings[k] = {triangle.colors[k][0],         triangle.colors[k][1],         triangle.colors[k][2],
+                     triangle.source_weights[k][0], triangle.source_weights[k][1], triangle.source_weights[k][2]};
+    }
+    framebuffer->DrawTriangleShaded(triangle.screen_points[0], triangle.screen_points[1], triangle.screen_points[2],
+                                    varyings[0], varyings[1], varyings[2], triangle.depths[0], triangle.depths[1],
+                                    triangle.depths[2], shader, clip);
+    return;
   }
+
+  framebuffer->DrawTriangleFilled(triangle.screen_points[0], triangle.screen_points[1], triangle.screen_points[2],
+                                  triangle.colors[0], triangle.colors[1], triangle.colors[2], triangle.depths[0],
+                                  triangle.depths[1], triangle.depths[2], clip);
 }
 
-void Scene::HandleMouseButton(int button, int action, int mods) {
-  if (action == GLFW_PRESS) {
-    double u_coordinate;
-    double v_coordinate;
-    glfwGetCursorPos(framebuffer->window, &u_coordinate, &v_coordinate);
-
-    if (button == GLFW_MOUSE_BUTTON_LEFT) {
-      std::cout << "Left click at (" << u_coordinate << ", " << v_coordinate << ")" << '\n';
-    } else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
-      std::cout << "Right click at (" << u_coordinate << ", " << v_coordinate << ")" << '\n';
-    } else if (button == GLFW_MOUSE_BUTTON_MIDDLE) {
-      std::cout << "Middle click at (" << u_coordinate << ", " << v_coordinate << ")" << '\n';
-    }
+void Scene::DrawProjectedTriangles(TriangleMesh *mesh, bool use_lighting) {
+  ClipRectangle bounds = framebuffer->GetBounds();
+  for (int i = 0; i < static_cast<int>(projected_triangles.size()); i++) {
+    DrawProjectedTriangle(mesh, use_lighting, i, bounds);
   }
 }
 
-void Scene::HandleCursorPosition(double u_coordinate, double v_coordinate) {}
+void Scene::DrawProjectedTrianglesTiled(TriangleMesh *mesh, bool use_lighting) {
+  tile_binner.Reset(framebuffer->width, framebuffer->height);
 
-void Scene::HandleScroll(double u_offset, double v_offset) {}
+  for (int i = 0; i < static_cast<int>(projected_triangles.size()); i++) {
+    auto &points = projected_triangles[i].screen_points;
+    float min_u = std::min({points[0][0], points[1][0], points[2][0]});
+    float max_u = std::max({points[0][0], points[1][0], points[2][0]});
+    float min_v = std::min({points[0][1], points[1][1], points[2][1]});
+    float max_v = std::max({points[0][1], points[1][1], points[2][1]});
+    tile_binner.Insert(i, min_u, min_v, max_u, max_v);
+  }
 
-void Scene::DBG() {
-  glfwMakeContextCurrent(framebuffer->window);
+  thread_pool->ParallelFor(tile_binner.GetTileCount(), [&](int tile_index) {
+    Profiler::ScopedTimer timer(Profiler::RASTERIZATION_TILE);
+    ClipRectangle tile = tile_binner.GetTileRectangle(tile_index);
+    for (int triangle_index : tile_binner.bins[tile_index]) {
+      DrawProjectedTriangle(mesh, use_lighting, triangle_index, tile);
+    }
+  });
+}
 
-  constexpr int stepsN = 100;
-  for (int si = 0; si < stepsN; si++) {
-    framebuffer->FillBackground(Color::WHITE);
+void Scene::ShadeVisibilityBuffer(TriangleMesh *mesh, bool use_lighting) {
+  bool has_statistics = framebuffer->HasStatistics();
+  thread_pool->ParallelFor(framebuffer->height, [&](int v_coordinate) {
+    for (int u_coordinate = 0; u_coordinate < framebuffer->width; u_coordinate++) {
+      long index = framebuffer->GetIndex(u_coordinate, v_coordinate);
+      unsigned int visibility = framebuffer->visibility_buffer[index];
+      if (visibility == EMPTY_VISIBILITY) {
+        continue;
+      }
 
-    int v_coordinate = (framebuffer->height / 2) + si;
-    if (v_coordinate >= framebuffer->height) {
-      break;
+      const ProjectedTriangle &triangle = projected_triangles[visibility - 1];
+      framebuffer->pixels[index] =
+          ShadeVisiblePixel(mesh, triangle, static_cast<float>(u_coordinate) + SpanKernels::PIXEL_CENTER_OFFSET,
+                            static_cast<float>(v_coordinate) + SpanKernels::PIXEL_CENTER_OFFSET, use_lighting);
+      if (has_statistics) {
+        framebuffer->pixel_statistics[index].shaded_fragments++;
+      }
     }
+  });
+}
 
-    for (int u_coordinate = stepsN; u_coordinate < stepsN * 2; u_coordinate++) {
-      framebuffer->SetPixel(u_coordinate, v_coordinate, Color::BLACK);
-    }
+// Barycentrics are recovered from the screen-space edge functions and then weighted by each vertex's 1/z, so the
+// attributes fetched from the mesh are interpolated perspective-correctly. Source weights map them back from a
+// clipped triangle to the mesh triangle it came from.
+auto Scene::ShadeVisiblePixel(TriangleMesh *mesh, const ProjectedTriangle &triangle, float u_coordinate,
+                              float v_coordinate, bool use_lighting) -> unsigned int {
+  std::array<Vector3, 3> points = triangle.screen_points;
+  std::array<float, 3> weights;
+  float weight_sum = 0.0F;
+  for (int k = 0; k < 3; k++) {
+    Vector3 start = points[(k + 1) % 3];
+    Vector3 end = points[(k + 2) % 3];
+    float edge_u = end[0] - start[0];
+    float edge_v = end[1] - start[1];
+    float pixel_value = (edge_u * (v_coordinate - start[1])) - (edge_v * (u_coordinate - start[0]));
+    float vertex_value = (edge_u * (points[k][1] - start[1])) - (edge_v * (points[k][0] - start[0]));
+    weights[k] = (pixel_value / vertex_value) * triangle.depths[k];
+    weight_sum += weights[k];
+  }
+  for (auto &weight : weights) {
+    weight /= weight_sum;
+  }
 
-    framebuffer->Render();
-    glfwPollEvents();
+  std::array<Vector3, 3> source_weights = triangle.source_weights;
+  Vector3 mesh_weights = (source_weights[0] * weights[0]) + (source_weights[1] * weights[1]) +
+                         (source_weights[2] * weights[2]);
+
+  std::array<unsigned int, 3> indices;
+  for (int k = 0; k < 3; k++) {
+    indices[k] = mesh->triangles[(triangle.mesh_triangle_index * 3) + k];
   }
 
-  std::cerr << '\n';
-  std::cerr << "INFO: pressed DBG button on GUI" << '\n';
+  std::array<Vector3, 3> colors = triangle.colors;
+  Vector3 color = (colors[0] * weights[0]) + (colors[1] * weights[1]) + (colors[2] * weights[2]);
+  return ShadeFragment(mesh, indices, color, mesh_weights, use_lighting);
+}
+
+auto Scene::MeshShader::operator()(const Varyings &varyings) const -> unsigned int {
+  return scene->ShadeFragment(mesh, indices, Vector3(varyings[0], varyings[1], varyings[2]),
+                              Vector3(varyings[3], varyings[4], varyings[5]), use_lighting);
 }
 
-auto main(int argc, char *argv[]) -> int {
-  if (glfwInit() == 0) {
-    std::cerr << "Failed to initialize GLFW" << '\n';
-    return -1;
+// Meshes without a texture and unlit meshes shade to their interpolated vertex color.
+auto Scene::IsFragmentShaded(TriangleMesh *mesh, bool use_lighting) -> bool {
+  bool is_textured = mesh->texture != nullptr && mesh->texture_coordinates.size() == mesh->vertices.size() * 2;
+  bool is_lit = use_lighting && mesh->normals.size() == mesh->vertices.size();
+  return is_textured || is_lit;
+}
+
+// The color of one fragment of the mesh triangle with the given vertex indices: the interpolated vertex color, times
+// the texture and the lighting when the mesh has them. mesh_weights are the fragment's barycentric weights with
+// respect to the mesh triangle.
+auto Scene::ShadeFragment(TriangleMesh *mesh, const std::array<unsigned int, 3> &indices, Vector3 color,
+                          Vector3 mesh_weights, bool use_lighting) -> unsigned int {
+  if (mesh->texture != nullptr && mesh->texture_coordinates.size() == mesh->vertices.size() * 2) {
+    float u_texture = 0.0F;
+    float v_texture = 0.0F;
+    for (int k = 0; k < 3; k++) {
+      u_texture += mesh->texture_coordinates[(indices[k] * 2) + 0] * mesh_weights[k];
+      v_texture += mesh->texture_coordinates[(indices[k] * 2) + 1] * mesh_weights[k];
+    }
+
+    Vector3 texel;
+    texel.SetColor(mesh->texture->Sample(u_texture, v_texture));
+    color = Vector3(color[0] * texel[0], color[1] * texel[1], color[2] * texel[2]);
   }
 
-  scene = new Scene();
-  scene->Run();
+  if (!use_lighting || mesh->normals.size() != mesh->vertices.size()) {
+    return color.GetColor();
+  }
 
-  delete scene;
-  glfwTerminate();
+  Vector3 point = (mesh->vertices[indices[0]] * mesh_weights[0]) + (mesh->vertices[indices[1]] * mesh_weights[1]) +
+                  (mesh->vertices[indices[2]] * mesh_weights[2]);
+  Vector3 normal = ((mesh->normals[indices[0]] * mesh_weights[0]) + (mesh->normals[indices[1]] * mesh_weights[1]) +
+                    (mesh->normals[indices[2]] * mesh_weights[2]))
+                       .GetNormal();
 
-  return 0;
-}
\ No newline at end of file
+  Vector3 light(ambient_coefficient, ambient_coefficient, ambient_coefficient);
+  if (shadow_map == nullptr || !shadow_map->IsInShadow(point, SHADOW_EPSILON)) {
+    light = lighting.ComputeLighting(point, normal, (camera->position - point).GetNormal(), lights,
+                                     ambient_coefficient, specular_exponent);
+  }
+
+  return Vector3(color[0] * light[0], color[1] * light[1], color[2] * light[2]).GetColor();
+}
@@ -4,6 +4,7 @@
 #include <cmath>
 
 #include "graphics_pipeline/matrix_3x3.h"
+#include "graphics_pipeline/span_kernels.h"
 
 ShadowMap::ShadowMap(int _width, int _height) : width(_width), height(_height) {
   constexpr float DEFAULT_LIGHT_FOV = 1.5F;
@@ -44,7 +45,9 @@ void ShadowMap::SetDepthBuffer(int u_coordinate, int v_coordinate, float depth)
   depth_buffer[idx] = depth;
 }
 
-void ShadowMap::ClearDepthBuffer() { std::ranges::fill(depth_buffer.begin(), depth_buffer.end(), 0.0F); }
+void ShadowMap::ClearDepthBuffer() {
+  SpanKernels::FillBuffer(depth_buffer.data(), static_cast<long>(depth_buffer.size()), 0.0F);
+}
 
 auto ShadowMap::IsInShadow(Vector3 world_point, float epsilon) -> bool {
   Vector3 light_space;
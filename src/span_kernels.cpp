@@ -0,0 +1,666 @@
+#include "graphics_pipeline/span_kernels.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "graphics_pipeline/color.h"
+#include "graphics_pipeline/texture.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRAPHICS_PIPELINE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+constexpr float ROUNDING_THRESHOLD = 0.5F;
+
+auto DetectInstructionSet() -> SpanKernels::InstructionSet {
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") != 0) {
+    return SpanKernels::AVX2;
+  }
+  if (__builtin_cpu_supports("sse2") != 0) {
+    return SpanKernels::SSE2;
+  }
+#endif
+  return SpanKernels::SCALAR;
+}
+
+SpanKernels::InstructionSet supported_instruction_set = DetectInstructionSet();
+SpanKernels::InstructionSet active_instruction_set = supported_instruction_set;
+
+auto QuantizeChannel(float value) -> unsigned int {
+  float scaled = std::min(std::max(value, 0.0F), 1.0F) * Color::MAX_ALPHA_CHANNEL;
+  float whole = truncf(scaled);
+  return static_cast<unsigned int>(whole) + ((scaled - whole >= ROUNDING_THRESHOLD) ? 1U : 0U);
+}
+
+// Depth policies for the scalar kernels. The float format keeps the original comparison so that NaN depths are
+// handled exactly as before, and the vector kernels use the matching unordered not-less-equal compare; the compact
+// formats compare quantized codes.
+struct Float32Depth {
+  static auto IsNearer(const SpanKernels::Span &span, long offset, float depth) -> bool {
+    return !(depth <= span.depth_row[offset]);
+  }
+  static void Store(const SpanKernels::Span &span, long offset, float depth) { span.depth_row[offset] = depth; }
+};
+
+struct Unorm24Depth {
+  static constexpr float MAX_CODE = SpanKernels::UNORM24_MAX;
+  static auto IsNearer(const SpanKernels::Span &span, long offset, float depth) -> bool {
+    return span.GetDepthCode(depth) > span.depth_row_24[offset];
+  }
+  static void Store(const SpanKernels::Span &span, long offset, float depth) {
+    span.depth_row_24[offset] = span.GetDepthCode(depth);
+  }
+};
+
+struct Unorm16Depth {
+  static constexpr float MAX_CODE = SpanKernels::UNORM16_MAX;
+  static auto IsNearer(const SpanKernels::Span &span, long offset, float depth) -> bool {
+    return span.GetDepthCode(depth) > span.depth_row_16[offset];
+  }
+  static void Store(const SpanKernels::Span &span, long offset, float depth) {
+    span.depth_row_16[offset] = static_cast<std::uint16_t>(span.GetDepthCode(depth));
+  }
+};
+
+template <typename Element> void FillBufferScalar(Element *target, long begin, long count, Element value) {
+  std::fill(target + begin, target + count, value);
+}
+
+void FillFlatScalar(const SpanKernels::Span &span, int begin_u, int end_u, unsigned int color) {
+  for (int u_coordinate = begin_u; u_coordinate <= end_u; u_coordinate++) {
+    span.pixel_row[span.GetOffset(u_coordinate)] = color;
+  }
+}
+
+template <typename Depth = Float32Depth>
+auto FillDepthTestedScalar(const SpanKernels::Span &span, int begin_u, int end_u, SpanKernels::Plane depth,
+                           unsigned int value) -> int {
+  int written_count = 0;
+  for (int u_coordinate = begin_u; u_coordinate <= end_u; u_coordinate++) {
+    long offset = span.GetOffset(u_coordinate);
+    float current_depth = depth.At(span.GetDeltaU(u_coordinate));
+    if (!Depth::IsNearer(span, offset, current_depth)) {
+      continue;
+    }
+
+    span.pixel_row[offset] = value;
+    Depth::Store(span, offset, current_depth);
+    written_count++;
+  }
+  return written_count;
+}
+
+template <typename Depth = Float32Depth>
+auto ShadeColorScalar(const SpanKernels::Span &span, int begin_u, int end_u, SpanKernels::Plane depth,
+                      const std::array<SpanKernels::Plane, 3> &color) -> int {
+  int written_count = 0;
+  for (int u_coordinate = begin_u; u_coordinate <= end_u; u_coordinate++) {
+    float delta_u = span.GetDeltaU(u_coordinate);
+    long offset = span.GetOffset(u_coordinate);
+    float current_depth = depth.At(delta_u);
+    if (!Depth::IsNearer(span, offset, current_depth)) {
+      continue;
+    }
+
+    span.pixel_row[offset] =
+        SpanKernels::PackColor(color[0].At(delta_u), color[1].At(delta_u), color[2].At(delta_u));
+    Depth::Store(span, offset, current_depth);
+    written_count++;
+  }
+  return written_count;
+}
+
+template <typename Depth = Float32Depth>
+auto ShadeTextureScalar(const SpanKernels::Span &span, int begin_u, int end_u, SpanKernels::Plane depth,
+                        SpanKernels::Plane u_texture, SpanKernels::Plane v_texture, Texture *texture) -> int {
+  int written_count = 0;
+  for (int u_coordinate = begin_u; u_coordinate <= end_u; u_coordinate++) {
+    float delta_u = span.GetDeltaU(u_coordinate);
+    long offset = span.GetOffset(u_coordinate);
+    float current_depth = depth.At(delta_u);
+    if (!Depth::IsNearer(span, offset, current_depth)) {
+      continue;
+    }
+
+    float inverse_depth = 1.0F / current_depth;
+    span.pixel_row[offset] =
+        texture->Sample(u_texture.At(delta_u) * inverse_depth, v_texture.At(delta_u) * inverse_depth);
+    Depth::Store(span, offset, current_depth);
+    written_count++;
+  }
+  return written_count;
+}
+
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+constexpr int AVX2_WIDTH = 8;
+constexpr int SSE2_WIDTH = 4;
+
+struct Avx2Lanes {
+  __m256 delta_u;
+  __m256 valid;
+};
+
+__attribute__((target("avx2"))) auto GetLanesAvx2(const SpanKernels::Span &span, int u_coordinate) -> Avx2Lanes {
+  const __m256i lane_offsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256i lane_u = _mm256_add_epi32(_mm256_set1_epi32(u_coordinate), lane_offsets);
+
+  Avx2Lanes ret;
+  ret.delta_u =
+      _mm256_sub_ps(_mm256_add_ps(_mm256_cvtepi32_ps(lane_u), _mm256_set1_ps(SpanKernels::PIXEL_CENTER_OFFSET)),
+                    _mm256_set1_ps(span.origin_u));
+  ret.valid = _mm256_castsi256_ps(_mm256_and_si256(_mm256_cmpgt_epi32(lane_u, _mm256_set1_epi32(span.begin_u - 1)),
+                                                   _mm256_cmpgt_epi32(_mm256_set1_epi32(span.end_u + 1), lane_u)));
+  return ret;
+}
+
+// Vectors start on run boundaries so that each one covers a single contiguous run of the row.
+auto GetAlignedBeginAvx2(const SpanKernels::Span &span) -> int {
+  static_assert(SpanKernels::RUN_LENGTH % AVX2_WIDTH == 0);
+  return span.begin_u - (span.begin_u % AVX2_WIDTH);
+}
+
+__attribute__((target("avx2"))) auto AtAvx2(SpanKernels::Plane plane, __m256 delta_u) -> __m256 {
+  return _mm256_add_ps(_mm256_set1_ps(plane.row_value), _mm256_mul_ps(_mm256_set1_ps(plane.u_step), delta_u));
+}
+
+__attribute__((target("avx2"))) auto QuantizeChannelAvx2(__m256 value) -> __m256i {
+  __m256 scaled = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0F)),
+                                _mm256_set1_ps(Color::MAX_ALPHA_CHANNEL));
+  __m256i whole = _mm256_cvttps_epi32(scaled);
+  __m256 fraction = _mm256_sub_ps(scaled, _mm256_cvtepi32_ps(whole));
+  __m256i round_up = _mm256_castps_si256(_mm256_cmp_ps(fraction, _mm256_set1_ps(ROUNDING_THRESHOLD), _CMP_GE_OQ));
+  return _mm256_sub_epi32(whole, round_up);
+}
+
+__attribute__((target("avx2"))) auto PackColorAvx2(const std::array<SpanKernels::Plane, 3> &color, __m256 delta_u)
+    -> __m256i {
+  __m256i red = _mm256_slli_epi32(QuantizeChannelAvx2(AtAvx2(color[0], delta_u)), Color::RED_SHIFT);
+  __m256i green = _mm256_slli_epi32(QuantizeChannelAvx2(AtAvx2(color[1], delta_u)), Color::GREEN_SHIFT);
+  __m256i blue = _mm256_slli_epi32(QuantizeChannelAvx2(AtAvx2(color[2], delta_u)), Color::BLUE_SHIFT);
+  __m256i alpha = _mm256_set1_epi32(static_cast<int>(Color::ALPHA_CHANNEL_MASK));
+  return _mm256_or_si256(_mm256_or_si256(red, green), _mm256_or_si256(blue, alpha));
+}
+
+// Returns the number of elements written; the remainder is shorter than one vector.
+__attribute__((target("avx2"))) auto FillBufferAvx2(void *target, long count, int bits) -> long {
+  __m256i packed = _mm256_set1_epi32(bits);
+  long index = 0;
+  for (; index + AVX2_WIDTH <= count; index += AVX2_WIDTH) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(static_cast<std::uint32_t *>(target) + index), packed);
+  }
+  return index;
+}
+
+__attribute__((target("avx2"))) void FillFlatAvx2(const SpanKernels::Span &span, unsigned int color) {
+  __m256i packed = _mm256_set1_epi32(static_cast<int>(color));
+  for (int u_coordinate = GetAlignedBeginAvx2(span); u_coordinate <= span.end_u; u_coordinate += AVX2_WIDTH) {
+    __m256i mask = _mm256_castps_si256(GetLanesAvx2(span, u_coordinate).valid);
+    long offset = span.GetOffset(u_coordinate);
+    _mm256_maskstore_epi32(reinterpret_cast<int *>(span.pixel_row + offset), mask, packed);
+  }
+}
+
+__attribute__((target("avx2"))) auto FillDepthTestedAvx2(const SpanKernels::Span &span, SpanKernels::Plane depth,
+                                                         unsigned int value) -> int {
+  int written_count = 0;
+  __m256i packed = _mm256_set1_epi32(static_cast<int>(value));
+  for (int u_coordinate = GetAlignedBeginAvx2(span); u_coordinate <= span.end_u; u_coordinate += AVX2_WIDTH) {
+    Avx2Lanes lanes = GetLanesAvx2(span, u_coordinate);
+    long offset = span.GetOffset(u_coordinate);
+    __m256 current_depth = AtAvx2(depth, lanes.delta_u);
+    __m256 stored_depth = _mm256_maskload_ps(span.depth_row + offset, _mm256_castps_si256(lanes.valid));
+    __m256 mask = _mm256_and_ps(lanes.valid, _mm256_cmp_ps(current_depth, stored_depth, _CMP_NLE_UQ));
+    int lane_bits = _mm256_movemask_ps(mask);
+    if (lane_bits == 0) {
+      continue;
+    }
+
+    __m256i store_mask = _mm256_castps_si256(mask);
+    _mm256_maskstore_epi32(reinterpret_cast<int *>(span.pixel_row + offset), store_mask, packed);
+    _mm256_maskstore_ps(span.depth_row + offset, store_mask, current_depth);
+    written_count += std::popcount(static_cast<unsigned int>(lane_bits));
+  }
+  return written_count;
+}
+
+__attribute__((target("avx2"))) auto ShadeColorAvx2(const SpanKernels::Span &span, SpanKernels::Plane depth,
+                                                    const std::array<SpanKernels::Plane, 3> &color) -> int {
+  int written_count = 0;
+  for (int u_coordinate = GetAlignedBeginAvx2(span); u_coordinate <= span.end_u; u_coordinate += AVX2_WIDTH) {
+    Avx2Lanes lanes = GetLanesAvx2(span, u_coordinate);
+    long offset = span.GetOffset(u_coordinate);
+    __m256 current_depth = AtAvx2(depth, lanes.delta_u);
+    __m256 stored_depth = _mm256_maskload_ps(span.depth_row + offset, _mm256_castps_si256(lanes.valid));
+    __m256 mask = _mm256_and_ps(lanes.valid, _mm256_cmp_ps(current_depth, stored_depth, _CMP_NLE_UQ));
+    int lane_bits = _mm256_movemask_ps(mask);
+    if (lane_bits == 0) {
+      continue;
+    }
+
+    __m256i packed = PackColorAvx2(color, lanes.delta_u);
+    __m256i store_mask = _mm256_castps_si256(mask);
+    _mm256_maskstore_epi32(reinterpret_cast<int *>(span.pixel_row + offset), store_mask, packed);
+    _mm256_maskstore_ps(span.depth_row + offset, store_mask, current_depth);
+    written_count += std::popcount(static_cast<unsigned int>(lane_bits));
+  }
+  return written_count;
+}
+
+__attribute__((target("avx2"))) auto ShadeTextureAvx2(const SpanKernels::Span &span, SpanKernels::Plane depth,
+                                                      SpanKernels::Plane u_texture, SpanKernels::Plane v_texture,
+                                                      Texture *texture) -> int {
+  int written_count = 0;
+  std::array<float, AVX2_WIDTH> u_values;
+  std::array<float, AVX2_WIDTH> v_values;
+
+  for (int u_coordinate = GetAlignedBeginAvx2(span); u_coordinate <= span.end_u; u_coordinate += AVX2_WIDTH) {
+    Avx2Lanes lanes = GetLanesAvx2(span, u_coordinate);
+    long offset = span.GetOffset(u_coordinate);
+    __m256 current_depth = AtAvx2(depth, lanes.delta_u);
+    __m256 stored_depth = _mm256_maskload_ps(span.depth_row + offset, _mm256_castps_si256(lanes.valid));
+    __m256 mask = _mm256_and_ps(lanes.valid, _mm256_cmp_ps(current_depth, stored_depth, _CMP_NLE_UQ));
+    int lane_bits = _mm256_movemask_ps(mask);
+    if (lane_bits == 0) {
+      continue;
+    }
+
+    __m256 inverse_depth = _mm256_div_ps(_mm256_set1_ps(1.0F), current_depth);
+    _mm256_storeu_ps(u_values.data(), _mm256_mul_ps(AtAvx2(u_texture, lanes.delta_u), inverse_depth));
+    _mm256_storeu_ps(v_values.data(), _mm256_mul_ps(AtAvx2(v_texture, lanes.delta_u), inverse_depth));
+    _mm256_maskstore_ps(span.depth_row + offset, _mm256_castps_si256(mask), current_depth);
+    written_count += std::popcount(static_cast<unsigned int>(lane_bits));
+
+    for (int lane = 0; lane < AVX2_WIDTH; lane++) {
+      if ((lane_bits & (1 << lane)) != 0) {
+        span.pixel_row[offset + lane] = texture->Sample(u_values[lane], v_values[lane]);
+      }
+    }
+  }
+  return written_count;
+}
+
+// There is no masked 16-bit load, so the compact depth kernels only process full vectors that start on a vector
+// boundary, and the head and tail of the span go through the scalar path.
+auto GetAlignedBeginCompactAvx2(const SpanKernels::Span &span) -> int {
+  return ((span.begin_u + AVX2_WIDTH - 1) / AVX2_WIDTH) * AVX2_WIDTH;
+}
+
+__attribute__((target("avx2"))) auto LoadDepthCodesAvx2(Unorm24Depth /*format*/, const SpanKernels::Span &span,
+                                                        long offset) -> __m256i {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(span.depth_row_24 + offset));
+}
+
+__attribute__((target("avx2"))) auto LoadDepthCodesAvx2(Unorm16Depth /*format*/, const SpanKernels::Span &span,
+                                                        long offset) -> __m256i {
+  return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(span.depth_row_16 + offset)));
+}
+
+__attribute__((target("avx2"))) void StoreDepthCodesAvx2(Unorm24Depth /*format*/, const SpanKernels::Span &span,
+                                                         long offset, __m256i codes) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(span.depth_row_24 + offset), codes);
+}
+
+// Codes are at most 16 bits, so the saturating pack is exact; the permute gathers both packed halves into the low
+// 128 bits.
+__attribute__((target("avx2"))) void StoreDepthCodesAvx2(Unorm16Depth /*format*/, const SpanKernels::Span &span,
+                                                         long offset, __m256i codes) {
+  __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(codes, codes), 0x08);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(span.depth_row_16 + offset), _mm256_castsi256_si128(packed));
+}
+
+// Quantizes a vector of depths the same way as Span::GetDepthCode, stores the codes that pass the depth test and
+// returns the lanes that passed.
+template <typename Depth>
+__attribute__((target("avx2"))) auto TestDepthCodesAvx2(const SpanKernels::Span &span, long offset,
+                                                        __m256 current_depth) -> __m256i {
+  __m256 scaled = _mm256_mul_ps(current_depth, _mm256_set1_ps(span.depth_code_scale));
+  __m256i codes = _mm256_cvttps_epi32(
+      _mm256_min_ps(_mm256_max_ps(scaled, _mm256_setzero_ps()), _mm256_set1_ps(Depth::MAX_CODE)));
+  __m256i stored_codes = LoadDepthCodesAvx2(Depth{}, span, offset);
+  __m256i mask = _mm256_cmpgt_epi32(codes, stored_codes);
+  if (_mm256_testz_si256(mask, mask) == 0) {
+    StoreDepthCodesAvx2(Depth{}, span, offset, _mm256_blendv_epi8(stored_codes, codes, mask));
+  }
+  return mask;
+}
+
+template <typename Depth>
+__attribute__((target("avx2"))) auto FillDepthTestedCompactAvx2(const SpanKernels::Span &span,
+                                                                SpanKernels::Plane depth, unsigned int value) -> int {
+  __m256i packed = _mm256_set1_epi32(static_cast<int>(value));
+  int u_coordinate = GetAlignedBeginCompactAvx2(span);
+  int written_count =
+      FillDepthTestedScalar<Depth>(span, span.begin_u, std::min(u_coordinate - 1, span.end_u), depth, value);
+  for (; u_coordinate + AVX2_WIDTH - 1 <= span.end_u; u_coordinate += AVX2_WIDTH) {
+    long offset = span.GetOffset(u_coordinate);
+    __m256i mask = TestDepthCodesAvx2<Depth>(span, offset, AtAvx2(depth, GetLanesAvx2(span, u_coordinate).delta_u));
+    int lane_bits = _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+    if (lane_bits == 0) {
+      continue;
+    }
+
+    _mm256_maskstore_epi32(reinterpret_cast<int *>(span.pixel_row + offset), mask, packed);
+    written_count += std::popcount(static_cast<unsigned int>(lane_bits));
+  }
+  return FillDepthTestedScalar<Depth>(span, u_coordinate, span.end_u, depth, value) + written_count;
+}
+
+template <typename Depth>
+__attribute__((target("avx2"))) auto ShadeColorCompactAvx2(const SpanKernels::Span &span, SpanKernels::Plane depth,
+                                                           const std::array<SpanKernels::Plane, 3> &color) -> int {
+  int u_coordinate = GetAlignedBeginCompactAvx2(span);
+  int written_count = ShadeColorScalar<Depth>(span, span.begin_u, std::min(u_coordinate - 1, span.end_u), depth, color);
+  for (; u_coordinate + AVX2_WIDTH - 1 <= span.end_u; u_coordinate += AVX2_WIDTH) {
+    __m256 delta_u = GetLanesAvx2(span, u_coordinate).delta_u;
+    long offset = span.GetOffset(u_coordinate);
+    __m256i mask = TestDepthCodesAvx2<Depth>(span, offset, AtAvx2(depth, delta_u));
+    int lane_bits = _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+    if (lane_bits == 0) {
+      continue;
+    }
+
+    _mm256_maskstore_epi32(reinterpret_cast<int *>(span.pixel_row + offset), mask, PackColorAvx2(color, delta_u));
+    written_count += std::popcount(static_cast<unsigned int>(lane_bits));
+  }
+  return ShadeColorScalar<Depth>(span, u_coordinate, span.end_u, depth, color) + written_count;
+}
+
+template <typename Depth>
+__attribute__((target("avx2"))) auto ShadeTextureCompactAvx2(const SpanKernels::Span &span, SpanKernels::Plane depth,
+                                                             SpanKernels::Plane u_texture,
+                                                             SpanKernels::Plane v_texture, Texture *texture) -> int {
+  std::array<float, AVX2_WIDTH> u_values;
+  std::array<float, AVX2_WIDTH> v_values;
+  int u_coordinate = GetAlignedBeginCompactAvx2(span);
+  int written_count = ShadeTextureScalar<Depth>(span, span.begin_u, std::min(u_coordinate - 1, span.end_u), depth,
+                                                u_texture, v_texture, texture);
+  for (; u_coordinate + AVX2_WIDTH - 1 <= span.end_u; u_coordinate += AVX2_WIDTH) {
+    __m256 delta_u = GetLanesAvx2(span, u_coordinate).delta_u;
+    long offset = span.GetOffset(u_coordinate);
+    __m256 current_depth = AtAvx2(depth, delta_u);
+    int lane_bits = _mm256_movemask_ps(_mm256_castsi256_ps(TestDepthCodesAvx2<Depth>(span, offset, current_depth)));
+    if (lane_bits == 0) {
+      continue;
+    }
+
+    __m256 inverse_depth = _mm256_div_ps(_mm256_set1_ps(1.0F), current_depth);
+    _mm256_storeu_ps(u_values.data(), _mm256_mul_ps(AtAvx2(u_texture, delta_u), inverse_depth));
+    _mm256_storeu_ps(v_values.data(), _mm256_mul_ps(AtAvx2(v_texture, delta_u), inverse_depth));
+    written_count += std::popcount(static_cast<unsigned int>(lane_bits));
+
+    for (int lane = 0; lane < AVX2_WIDTH; lane++) {
+      if ((lane_bits & (1 << lane)) != 0) {
+        span.pixel_row[offset + lane] = texture->Sample(u_values[lane], v_values[lane]);
+      }
+    }
+  }
+  return ShadeTextureScalar<Depth>(span, u_coordinate, span.end_u, depth, u_texture, v_texture, texture) +
+         written_count;
+}
+
+auto GetDeltaUSse2(const SpanKernels::Span &span, int u_coordinate) -> __m128 {
+  __m128i lane_u = _mm_add_epi32(_mm_set1_epi32(u_coordinate), _mm_setr_epi32(0, 1, 2, 3));
+  return _mm_sub_ps(_mm_add_ps(_mm_cvtepi32_ps(lane_u), _mm_set1_ps(SpanKernels::PIXEL_CENTER_OFFSET)),
+                    _mm_set1_ps(span.origin_u));
+}
+
+auto AtSse2(SpanKernels::Plane plane, __m128 delta_u) -> __m128 {
+  return _mm_add_ps(_mm_set1_ps(plane.row_value), _mm_mul_ps(_mm_set1_ps(plane.u_step), delta_u));
+}
+
+auto BlendSse2(__m128i mask, __m128i new_value, __m128i old_value) -> __m128i {
+  return _mm_or_si128(_mm_and_si128(mask, new_value), _mm_andnot_si128(mask, old_value));
+}
+
+auto QuantizeChannelSse2(__m128 value) -> __m128i {
+  __m128 scaled = _mm_mul_ps(_mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0F)),
+                             _mm_set1_ps(Color::MAX_ALPHA_CHANNEL));
+  __m128i whole = _mm_cvttps_epi32(scaled);
+  __m128 fraction = _mm_sub_ps(scaled, _mm_cvtepi32_ps(whole));
+  return _mm_sub_epi32(whole, _mm_castps_si128(_mm_cmpge_ps(fraction, _mm_set1_ps(ROUNDING_THRESHOLD))));
+}
+
+// Only full vectors that start on a run-aligned boundary are processed here, so no vector crosses a run or reaches
+// past the span. The unaligned head goes through the scalar path first.
+auto GetAlignedBeginSse2(const SpanKernels::Span &span) -> int {
+  static_assert(SpanKernels::RUN_LENGTH % SSE2_WIDTH == 0);
+  return ((span.begin_u + SSE2_WIDTH - 1) / SSE2_WIDTH) * SSE2_WIDTH;
+}
+
+auto FillBufferSse2(void *target, long count, int bits) -> long {
+  __m128i packed = _mm_set1_epi32(bits);
+  long index = 0;
+  for (; index + SSE2_WIDTH <= count; index += SSE2_WIDTH) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(static_cast<std::uint32_t *>(target) + index), packed);
+  }
+  return index;
+}
+
+auto FillFlatSse2(const SpanKernels::Span &span, unsigned int color) -> int {
+  __m128i packed = _mm_set1_epi32(static_cast<int>(color));
+  int u_coordinate = GetAlignedBeginSse2(span);
+  FillFlatScalar(span, span.begin_u, std::min(u_coordinate - 1, span.end_u), color);
+  for (; u_coordinate + SSE2_WIDTH - 1 <= span.end_u; u_coordinate += SSE2_WIDTH) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(span.pixel_row + span.GetOffset(u_coordinate)), packed);
+  }
+  return u_coordinate;
+}
+
+auto FillDepthTestedSse2(const SpanKernels::Span &span, SpanKernels::Plane depth, unsigned int value,
+                         int &written_count) -> int {
+  __m128i packed = _mm_set1_epi32(static_cast<int>(value));
+  int u_coordinate = GetAlignedBeginSse2(span);
+  written_count = FillDepthTestedScalar(span, span.begin_u, std::min(u_coordinate - 1, span.end_u), depth, value);
+  for (; u_coordinate + SSE2_WIDTH - 1 <= span.end_u; u_coordinate += SSE2_WIDTH) {
+    long offset = span.GetOffset(u_coordinate);
+    __m128 current_depth = AtSse2(depth, GetDeltaUSse2(span, u_coordinate));
+    __m128 stored_depth = _mm_loadu_ps(span.depth_row + offset);
+    __m128 mask = _mm_cmpnle_ps(current_depth, stored_depth);
+    int lane_bits = _mm_movemask_ps(mask);
+    if (lane_bits == 0) {
+      continue;
+    }
+
+    auto *pixel_target = reinterpret_cast<__m128i *>(span.pixel_row + offset);
+    _mm_storeu_si128(pixel_target, BlendSse2(_mm_castps_si128(mask), packed, _mm_loadu_si128(pixel_target)));
+    _mm_storeu_ps(span.depth_row + offset,
+                  _mm_or_ps(_mm_and_ps(mask, current_depth), _mm_andnot_ps(mask, stored_depth)));
+    written_count += std::popcount(static_cast<unsigned int>(lane_bits));
+  }
+  return u_coordinate;
+}
+
+auto ShadeColorSse2(const SpanKernels::Span &span, SpanKernels::Plane depth,
+                    const std::array<SpanKernels::Plane, 3> &color, int &written_count) -> int {
+  int u_coordinate = GetAlignedBeginSse2(span);
+  written_count = ShadeColorScalar(span, span.begin_u, std::min(u_coordinate - 1, span.end_u), depth, color);
+  for (; u_coordinate + SSE2_WIDTH - 1 <= span.end_u; u_coordinate += SSE2_WIDTH) {
+    __m128 delta_u = GetDeltaUSse2(span, u_coordinate);
+    long offset = span.GetOffset(u_coordinate);
+    __m128 current_depth = AtSse2(depth, delta_u);
+    __m128 stored_depth = _mm_loadu_ps(span.depth_row + offset);
+    __m128 mask = _mm_cmpnle_ps(current_depth, stored_depth);
+    int lane_bits = _mm_movemask_ps(mask);
+    if (lane_bits == 0) {
+      continue;
+    }
+
+    __m128i red = _mm_slli_epi32(QuantizeChannelSse2(AtSse2(color[0], delta_u)), Color::RED_SHIFT);
+    __m128i green = _mm_slli_epi32(QuantizeChannelSse2(AtSse2(color[1], delta_u)), Color::GREEN_SHIFT);
+    __m128i blue = _mm_slli_epi32(QuantizeChannelSse2(AtSse2(color[2], delta_u)), Color::BLUE_SHIFT);
+    __m128i alpha = _mm_set1_epi32(static_cast<int>(Color::ALPHA_CHANNEL_MASK));
+    __m128i packed = _mm_or_si128(_mm_or_si128(red, green), _mm_or_si128(blue, alpha));
+
+    __m128i integer_mask = _mm_castps_si128(mask);
+    auto *pixel_target = reinterpret_cast<__m128i *>(span.pixel_row + offset);
+    _mm_storeu_si128(pixel_target, BlendSse2(integer_mask, packed, _mm_loadu_si128(pixel_target)));
+    _mm_storeu_ps(span.depth_row + offset,
+                  _mm_or_ps(_mm_and_ps(mask, current_depth), _mm_andnot_ps(mask, stored_depth)));
+    written_count += std::popcount(static_cast<unsigned int>(lane_bits));
+  }
+  return u_coordinate;
+}
+#endif
+
+// The compact depth formats only have an AVX2 path; other instruction sets use the scalar kernels for them.
+template <typename Depth>
+auto FillDepthTestedCompact(const SpanKernels::Span &span, SpanKernels::Plane depth, unsigned int value) -> int {
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  if (active_instruction_set == SpanKernels::AVX2) {
+    return FillDepthTestedCompactAvx2<Depth>(span, depth, value);
+  }
+#endif
+  return FillDepthTestedScalar<Depth>(span, span.begin_u, span.end_u, depth, value);
+}
+
+template <typename Depth>
+auto ShadeColorCompact(const SpanKernels::Span &span, SpanKernels::Plane depth,
+                       const std::array<SpanKernels::Plane, 3> &color) -> int {
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  if (active_instruction_set == SpanKernels::AVX2) {
+    return ShadeColorCompactAvx2<Depth>(span, depth, color);
+  }
+#endif
+  return ShadeColorScalar<Depth>(span, span.begin_u, span.end_u, depth, color);
+}
+
+template <typename Depth>
+auto ShadeTextureCompact(const SpanKernels::Span &span, SpanKernels::Plane depth, SpanKernels::Plane u_texture,
+                         SpanKernels::Plane v_texture, Texture *texture) -> int {
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  if (active_instruction_set == SpanKernels::AVX2) {
+    return ShadeTextureCompactAvx2<Depth>(span, depth, u_texture, v_texture, texture);
+  }
+#endif
+  return ShadeTextureScalar<Depth>(span, span.begin_u, span.end_u, depth, u_texture, v_texture, texture);
+}
+} // namespace
+
+auto SpanKernels::GetSupportedInstructionSet() -> InstructionSet { return supported_instruction_set; }
+
+auto SpanKernels::GetInstructionSet() -> InstructionSet { return active_instruction_set; }
+
+void SpanKernels::SetInstructionSet(InstructionSet instruction_set) {
+  active_instruction_set = std::min(instruction_set, supported_instruction_set);
+}
+
+void SpanKernels::FillBuffer(unsigned int *target, long count, unsigned int value) {
+  long begin = 0;
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  if (active_instruction_set == AVX2) {
+    begin = FillBufferAvx2(target, count, std::bit_cast<int>(value));
+  } else if (active_instruction_set == SSE2) {
+    begin = FillBufferSse2(target, count, std::bit_cast<int>(value));
+  }
+#endif
+  FillBufferScalar(target, begin, count, value);
+}
+
+void SpanKernels::FillBuffer(float *target, long count, float value) {
+  long begin = 0;
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  if (active_instruction_set == AVX2) {
+    begin = FillBufferAvx2(target, count, std::bit_cast<int>(value));
+  } else if (active_instruction_set == SSE2) {
+    begin = FillBufferSse2(target, count, std::bit_cast<int>(value));
+  }
+#endif
+  FillBufferScalar(target, begin, count, value);
+}
+
+void SpanKernels::FillBuffer(std::uint16_t *target, long count, std::uint16_t value) {
+  long begin = 0;
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  constexpr int HALF_WORD_BITS = 16;
+  int bits = static_cast<int>((static_cast<std::uint32_t>(value) << HALF_WORD_BITS) | value);
+  if (active_instruction_set == AVX2) {
+    begin = 2 * FillBufferAvx2(target, count / 2, bits);
+  } else if (active_instruction_set == SSE2) {
+    begin = 2 * FillBufferSse2(target, count / 2, bits);
+  }
+#endif
+  FillBufferScalar(target, begin, count, value);
+}
+
+void SpanKernels::FillFlat(const Span &span, unsigned int color) {
+  int begin_u = span.begin_u;
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  if (active_instruction_set == AVX2) {
+    FillFlatAvx2(span, color);
+    return;
+  }
+  if (active_instruction_set == SSE2) {
+    begin_u = FillFlatSse2(span, color);
+  }
+#endif
+  FillFlatScalar(span, begin_u, span.end_u, color);
+}
+
+auto SpanKernels::FillDepthTested(const Span &span, Plane depth, unsigned int value) -> int {
+  if (span.depth_format == DEPTH_UNORM24) {
+    return FillDepthTestedCompact<Unorm24Depth>(span, depth, value);
+  }
+  if (span.depth_format == DEPTH_UNORM16) {
+    return FillDepthTestedCompact<Unorm16Depth>(span, depth, value);
+  }
+
+  int begin_u = span.begin_u;
+  int written_count = 0;
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  if (active_instruction_set == AVX2) {
+    return FillDepthTestedAvx2(span, depth, value);
+  }
+  if (active_instruction_set == SSE2) {
+    begin_u = FillDepthTestedSse2(span, depth, value, written_count);
+  }
+#endif
+  return FillDepthTestedScalar(span, begin_u, span.end_u, depth, value) + written_count;
+}
+
+auto SpanKernels::ShadeColor(const Span &span, Plane depth, const std::array<Plane, 3> &color) -> int {
+  if (span.depth_format == DEPTH_UNORM24) {
+    return ShadeColorCompact<Unorm24Depth>(span, depth, color);
+  }
+  if (span.depth_format == DEPTH_UNORM16) {
+    return ShadeColorCompact<Unorm16Depth>(span, depth, color);
+  }
+
+  int begin_u = span.begin_u;
+  int written_count = 0;
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  if (active_instruction_set == AVX2) {
+    return ShadeColorAvx2(span, depth, color);
+  }
+  if (active_instruction_set == SSE2) {
+    begin_u = ShadeColorSse2(span, depth, color, written_count);
+  }
+#endif
+  return ShadeColorScalar(span, begin_u, span.end_u, depth, color) + written_count;
+}
+
+auto SpanKernels::ShadeTexture(const Span &span, Plane depth, Plane u_texture, Plane v_texture, Texture *texture)
+    -> int {
+  if (span.depth_format == DEPTH_UNORM24) {
+    return ShadeTextureCompact<Unorm24Depth>(span, depth, u_texture, v_texture, texture);
+  }
+  if (span.depth_format == DEPTH_UNORM16) {
+    return ShadeTextureCompact<Unorm16Depth>(span, depth, u_texture, v_texture, texture);
+  }
+
+#ifdef GRAPHICS_PIPELINE_X86_KERNELS
+  if (active_instruction_set == AVX2) {
+    return ShadeTextureAvx2(span, depth, u_texture, v_texture, texture);
+  }
+#endif
+  return ShadeTextureScalar(span, span.begin_u, span.end_u, depth, u_texture, v_texture, texture);
+}
+
+auto SpanKernels::PackColor(float red, float green, float blue) -> unsigned int {
+  return (QuantizeChannel(red) << Color::RED_SHIFT) | (QuantizeChannel(green) << Color::GREEN_SHIFT) |
+         (QuantizeChannel(blue) << Color::BLUE_SHIFT) | Color::ALPHA_CHANNEL_MASK;
+}
@@ -0,0 +1,81 @@
+#include "graphics_pipeline/thread_pool.h"
+
+ThreadPool::ThreadPool(int thread_count)
+    : current_task(nullptr), next_task_index(0), current_task_count(0), busy_workers(0), generation(0),
+      stopping(false) {
+  for (int i = 1; i < thread_count; i++) {
+    workers.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+auto ThreadPool::GetThreadCount() -> int { return static_cast<int>(workers.size()) + 1; }
+
+void ThreadPool::ParallelFor(int task_count, const std::function<void(int)> &task) {
+  if (task_count <= 0) {
+    return;
+  }
+
+  if (workers.empty() || task_count == 1) {
+    for (int i = 0; i < task_count; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    current_task = &task;
+    current_task_count = task_count;
+    next_task_index = 0;
+    busy_workers = static_cast<int>(workers.size());
+    generation++;
+  }
+  work_available.notify_all();
+
+  RunTasks();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  work_finished.wait(lock, [&] { return busy_workers == 0; });
+  current_task = nullptr;
+}
+
+void ThreadPool::RunTasks() {
+  for (int i = next_task_index++; i < current_task_count; i = next_task_index++) {
+    (*current_task)(i);
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  long seen_generation = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      work_available.wait(lock, [&] { return stopping || generation != seen_generation; });
+      if (stopping) {
+        return;
+      }
+      seen_generation = generation;
+    }
+
+    RunTasks();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    busy_workers--;
+    if (busy_workers == 0) {
+      work_finished.notify_one();
+    }
+  }
+}
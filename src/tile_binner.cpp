@@ -0,0 +1,53 @@
+#include "graphics_pipeline/tile_binner.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Bins cover whole lazy-clear tiles, so threads rasterizing different bins never resolve the same tile.
+static_assert(TileBinner::TILE_SIZE % Framebuffer::CLEAR_TILE_SIZE == 0);
+
+TileBinner::TileBinner() : width(0), height(0), columns(0), rows(0) {}
+
+void TileBinner::Reset(int _width, int _height) {
+  width = _width;
+  height = _height;
+  columns = (width + TILE_SIZE - 1) / TILE_SIZE;
+  rows = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+  bins.resize(static_cast<long>(columns) * rows);
+  for (auto &bin : bins) {
+    bin.clear();
+  }
+}
+
+void TileBinner::Insert(int triangle_index, float min_u, float min_v, float max_u, float max_v) {
+  if (max_u < 0.0F || max_v < 0.0F || min_u >= static_cast<float>(width) || min_v >= static_cast<float>(height)) {
+    return;
+  }
+
+  int first_column = static_cast<int>(std::max(floorf(min_u), 0.0F)) / TILE_SIZE;
+  int last_column = static_cast<int>(std::min(ceilf(max_u), static_cast<float>(width - 1))) / TILE_SIZE;
+  int first_row = static_cast<int>(std::max(floorf(min_v), 0.0F)) / TILE_SIZE;
+  int last_row = static_cast<int>(std::min(ceilf(max_v), static_cast<float>(height - 1))) / TILE_SIZE;
+
+  for (int row = first_row; row <= last_row; row++) {
+    for (int column = first_column; column <= last_column; column++) {
+      bins[(row * columns) + column].push_back(triangle_index);
+    }
+  }
+}
+
+auto TileBinner::GetTileCount() -> int { return columns * rows; }
+
+auto TileBinner::GetTileRectangle(int tile_index) -> ClipRectangle {
+  int column = tile_index % columns;
+  int row = tile_index / columns;
+
+  ClipRectangle ret;
+  ret.min_u = column * TILE_SIZE;
+  ret.min_v = row * TILE_SIZE;
+  ret.max_u = std::min(ret.min_u + TILE_SIZE, width) - 1;
+  ret.max_v = std::min(ret.min_v + TILE_SIZE, height) - 1;
+
+  return ret;
+}
@@ -1,5 +1,6 @@
 #include "graphics_pipeline/triangle_mesh.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <fstream>
@@ -147,6 +148,61 @@ auto TriangleMesh::GetPosition() -> Vector3 {
 
 void TriangleMesh::SetPosition(Vector3 new_position) { Translate(new_position - GetPosition()); }
 
+// Edges are keyed by their sorted vertex pair and sorted, so the triangles sharing an edge end up next to each other.
+auto TriangleMesh::GetEdges() -> const std::vector<Edge> & {
+  std::uint64_t checksum = GetTrianglesChecksum();
+  if (checksum == edges_checksum) {
+    return edges;
+  }
+
+  constexpr int VERTEX_KEY_BITS = 32;
+  std::vector<std::pair<std::uint64_t, int>> keyed_edges;
+  keyed_edges.reserve(triangles.size());
+  for (int i = 0; i < static_cast<int>(triangles.size()) / 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      unsigned int start = triangles[(i * 3) + j];
+      unsigned int end = triangles[(i * 3) + ((j + 1) % 3)];
+      std::uint64_t key = (static_cast<std::uint64_t>(std::min(start, end)) << VERTEX_KEY_BITS) | std::max(start, end);
+      keyed_edges.emplace_back(key, i);
+    }
+  }
+  std::ranges::sort(keyed_edges);
+
+  edges.clear();
+  for (size_t i = 0; i < keyed_edges.size();) {
+    size_t group_end = i + 1;
+    while (group_end < keyed_edges.size() && keyed_edges[group_end].first == keyed_edges[i].first) {
+      group_end++;
+    }
+
+    Edge edge;
+    edge.vertices[0] = static_cast<unsigned int>(keyed_edges[i].first >> VERTEX_KEY_BITS);
+    edge.vertices[1] = static_cast<unsigned int>(keyed_edges[i].first);
+    edge.triangles[0] = keyed_edges[i].second;
+    edge.triangles[1] = group_end - i == 2 ? keyed_edges[i + 1].second : NO_TRIANGLE;
+    if (group_end - i > 2) {
+      edge.triangles[0] = NO_TRIANGLE;
+    }
+    edges.push_back(edge);
+    i = group_end;
+  }
+
+  edges_checksum = checksum;
+  return edges;
+}
+
+auto TriangleMesh::GetTrianglesChecksum() -> std::uint64_t {
+  constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+  constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+  std::uint64_t ret = FNV_OFFSET_BASIS ^ triangles.size();
+  for (unsigned int index : triangles) {
+    ret = (ret ^ index) * FNV_PRIME;
+  }
+
+  return ret;
+}
+
 void TriangleMesh::Scale(float factor) {
   Vector3 position = GetPosition();
   for (auto &vertex : vertices) {
@@ -195,7 +251,7 @@ auto TriangleMesh::AxisAlignedBox(Vector3 min_corner, Vector3 max_corner, unsign
       Vector3(max_corner[0], max_corner[1], max_corner[2]), Vector3(min_corner[0], max_corner[1], max_corner[2])};
 
   constexpr std::array<unsigned int, NUM_INDICES> triangle_indices = {
-      0, 1, 2, 0, 2, 3, 5, 4, 7, 5, 7, 6, 4, 0, 3, 4, 3, 7, 1, 5, 6, 1, 6, 2, 4, 5, 1, 4, 1, 0, 3, 2, 6, 3, 6, 7};
+      0, 2, 1, 0, 3, 2, 5, 7, 4, 5, 6, 7, 4, 3, 0, 4, 7, 3, 1, 6, 5, 1, 2, 6, 4, 1, 5, 4, 0, 1, 3, 6, 2, 3, 7, 6};
 
   constexpr std::array<std::array<float, 3>, NUM_VERTICES> normal_data = {{{-1.0F, -1.0F, -1.0F},
                                                                            {1.0F, -1.0F, -1.0F},
@@ -382,9 +438,9 @@ auto TriangleMesh::Cylinder(Vector3 position, float radius, float height, int su
     int top_next = subdivisions + next;
 
     const std::array<unsigned int, 6> quad_indices = {
-        static_cast<unsigned int>(bottom_current), static_cast<unsigned int>(bottom_next),
-        static_cast<unsigned int>(top_current),    static_cast<unsigned int>(bottom_next),
-        static_cast<unsigned int>(top_next),       static_cast<unsigned int>(top_current)};
+        static_cast<unsigned int>(bottom_current), static_cast<unsigned int>(top_current),
+        static_cast<unsigned int>(bottom_next),    static_cast<unsigned int>(bottom_next),
+        static_cast<unsigned int>(top_current),    static_cast<unsigned int>(top_next)};
 
     for (unsigned int index : quad_indices) {
       mesh.triangles[triangle_index++] = index;
@@ -394,7 +450,7 @@ auto TriangleMesh::Cylinder(Vector3 position, float radius, float height, int su
   for (int i = 0; i < subdivisions; i++) {
     int next = (i + 1) % subdivisions;
     const std::array<unsigned int, VERTICES_PER_TRIANGLE> cap_indices = {
-        static_cast<unsigned int>(bottom_center_index), static_cast<unsigned int>(next), static_cast<unsigned int>(i)};
+        static_cast<unsigned int>(bottom_center_index), static_cast<unsigned int>(i), static_cast<unsigned int>(next)};
 
     for (unsigned int index : cap_indices) {
       mesh.triangles[triangle_index++] = index;
@@ -404,8 +460,8 @@ auto TriangleMesh::Cylinder(Vector3 position, float radius, float height, int su
   for (int i = 0; i < subdivisions; i++) {
     int next = (i + 1) % subdivisions;
     const std::array<unsigned int, VERTICES_PER_TRIANGLE> cap_indices = {
-        static_cast<unsigned int>(top_center_index), static_cast<unsigned int>(subdivisions + i),
-        static_cast<unsigned int>(subdivisions + next)};
+        static_cast<unsigned int>(top_center_index), static_cast<unsigned int>(subdivisions + next),
+        static_cast<unsigned int>(subdivisions + i)};
 
     for (unsigned int index : cap_indices) {
       mesh.triangles[triangle_index++] = index;
@@ -449,7 +505,7 @@ auto TriangleMesh::Quad(Vector3 position, Vector3 normal, Vector3 up_hint, float
 
   mesh.texture_coordinates.assign(texture_coord_data.begin(), texture_coord_data.end());
 
-  mesh.triangles = {0, 1, 2, 0, 2, 3};
+  mesh.triangles = {0, 2, 1, 0, 3, 2};
   mesh.texture = nullptr;
 
   return mesh;
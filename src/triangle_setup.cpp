@@ -0,0 +1,131 @@
+#include "graphics_pipeline/triangle_setup.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr float DEPTH_BOUND_TOLERANCE = 1e-4F;
+
+auto FloorDivide(std::int64_t numerator, std::int64_t denominator) -> std::int64_t {
+  std::int64_t quotient = numerator / denominator;
+  return (numerator % denominator != 0 && numerator < 0) ? quotient - 1 : quotient;
+}
+
+auto CeilDivide(std::int64_t numerator, std::int64_t denominator) -> std::int64_t {
+  std::int64_t quotient = numerator / denominator;
+  return (numerator % denominator != 0 && numerator > 0) ? quotient + 1 : quotient;
+}
+} // namespace
+
+auto TriangleSetup::Initialize(Vector3 point_0, Vector3 point_1, Vector3 point_2, ClipRectangle clip) -> bool {
+  std::array<Vector3, 3> points = {point_0, point_1, point_2};
+  std::array<std::int64_t, 3> fixed_u;
+  std::array<std::int64_t, 3> fixed_v;
+  for (int k = 0; k < 3; k++) {
+    if (!(fabsf(points[k][0]) < MAX_FIXED_POINT_COORDINATE && fabsf(points[k][1]) < MAX_FIXED_POINT_COORDINATE)) {
+      return false;
+    }
+    fixed_u[k] = llroundf(points[k][0] * static_cast<float>(SUBPIXEL_SCALE));
+    fixed_v[k] = llroundf(points[k][1] * static_cast<float>(SUBPIXEL_SCALE));
+  }
+
+  for (int k = 0; k < 3; k++) {
+    int start = (k + 1) % 3;
+    int end = (k + 2) % 3;
+    edge_u_steps[k] = fixed_v[start] - fixed_v[end];
+    edge_v_steps[k] = fixed_u[end] - fixed_u[start];
+  }
+  std::int64_t area = (edge_u_steps[0] * (fixed_u[0] - fixed_u[1])) + (edge_v_steps[0] * (fixed_v[0] - fixed_v[1]));
+  if (area == 0) {
+    return false;
+  }
+
+  for (int k = 0; k < 3; k++) {
+    if (area < 0) {
+      edge_u_steps[k] = -edge_u_steps[k];
+      edge_v_steps[k] = -edge_v_steps[k];
+    }
+    int start = (k + 1) % 3;
+    edge_constants[k] = (edge_u_steps[k] * (SUBPIXEL_CENTER - fixed_u[start])) +
+                        (edge_v_steps[k] * (SUBPIXEL_CENTER - fixed_v[start]));
+    bool is_top_left = edge_u_steps[k] > 0 || (edge_u_steps[k] == 0 && edge_v_steps[k] > 0);
+    edge_thresholds[k] = is_top_left ? 0 : 1;
+
+    u_steps[k] = static_cast<float>(edge_u_steps[k]) / static_cast<float>(SUBPIXEL_SCALE);
+    v_steps[k] = static_cast<float>(edge_v_steps[k]) / static_cast<float>(SUBPIXEL_SCALE);
+  }
+  origin_u = static_cast<float>(fixed_u[0]) / static_cast<float>(SUBPIXEL_SCALE);
+  origin_v = static_cast<float>(fixed_v[0]) / static_cast<float>(SUBPIXEL_SCALE);
+  inverse_area = static_cast<float>(static_cast<double>(SUBPIXEL_SCALE * SUBPIXEL_SCALE) /
+                                    static_cast<double>(area < 0 ? -area : area));
+
+  auto get_first_center = [](std::int64_t lowest) { return CeilDivide(lowest - SUBPIXEL_CENTER, SUBPIXEL_SCALE); };
+  auto get_last_center = [](std::int64_t highest) { return FloorDivide(highest - SUBPIXEL_CENTER, SUBPIXEL_SCALE); };
+  min_u = static_cast<int>(std::max(get_first_center(std::min({fixed_u[0], fixed_u[1], fixed_u[2]})),
+                                    static_cast<std::int64_t>(clip.min_u)));
+  max_u = static_cast<int>(std::min(get_last_center(std::max({fixed_u[0], fixed_u[1], fixed_u[2]})),
+                                    static_cast<std::int64_t>(clip.max_u)));
+  min_v = static_cast<int>(std::max(get_first_center(std::min({fixed_v[0], fixed_v[1], fixed_v[2]})),
+                                    static_cast<std::int64_t>(clip.min_v)));
+  max_v = static_cast<int>(std::min(get_last_center(std::max({fixed_v[0], fixed_v[1], fixed_v[2]})),
+                                    static_cast<std::int64_t>(clip.max_v)));
+
+  return min_u <= max_u && min_v <= max_v;
+}
+
+// The covered pixels of a row form one interval; each edge bounds it from the left or the right depending on the
+// sign of its u step.
+auto TriangleSetup::GetSpan(int v_coordinate) const -> SpanKernels::Span {
+  std::int64_t begin_u = min_u;
+  std::int64_t end_u = max_u;
+  std::int64_t row_v = static_cast<std::int64_t>(v_coordinate) * SUBPIXEL_SCALE;
+  for (int k = 0; k < 3; k++) {
+    std::int64_t row_value = edge_constants[k] + (edge_v_steps[k] * row_v);
+    std::int64_t step = edge_u_steps[k] * SUBPIXEL_SCALE;
+    if (step > 0) {
+      begin_u = std::max(begin_u, CeilDivide(edge_thresholds[k] - row_value, step));
+    } else if (step < 0) {
+      end_u = std::min(end_u, FloorDivide(row_value - edge_thresholds[k], -step));
+    } else if (row_value < edge_thresholds[k]) {
+      end_u = begin_u - 1;
+    }
+  }
+
+  if (begin_u > end_u) {
+    begin_u = min_u;
+    end_u = min_u - 1;
+  }
+
+  SpanKernels::Span span;
+  span.begin_u = static_cast<int>(begin_u);
+  span.end_u = static_cast<int>(end_u);
+  span.origin_u = origin_u;
+  span.pixel_row = nullptr;
+  span.depth_row = nullptr;
+  span.depth_row_24 = nullptr;
+  span.depth_row_16 = nullptr;
+  span.depth_format = SpanKernels::DEPTH_FLOAT32;
+  span.depth_code_scale = 0.0F;
+  span.run_gap = 0;
+
+  return span;
+}
+
+auto TriangleSetup::GetDeltaV(int v_coordinate) const -> float {
+  return static_cast<float>(v_coordinate) + SpanKernels::PIXEL_CENTER_OFFSET - origin_v;
+}
+
+auto TriangleSetup::GetPlane(float value_0, float value_1, float value_2) const -> AttributePlane {
+  AttributePlane plane;
+  plane.u_step = ((u_steps[0] * value_0) + (u_steps[1] * value_1) + (u_steps[2] * value_2)) * inverse_area;
+  plane.v_step = ((v_steps[0] * value_0) + (v_steps[1] * value_1) + (v_steps[2] * value_2)) * inverse_area;
+  plane.origin_value = value_0;
+  return plane;
+}
+
+// Interpolated depths can overshoot the largest vertex depth by rounding, so the bound used against the
+// hierarchical z-buffer is padded slightly to keep rejection conservative.
+auto TriangleSetup::GetMaxDepth(float depth_0, float depth_1, float depth_2) -> float {
+  float max_depth = std::max({depth_0, depth_1, depth_2});
+  return max_depth + (fabsf(max_depth) * DEPTH_BOUND_TOLERANCE);
+}
@@ -1,5 +1,6 @@
 #include "graphics_pipeline/vector_3.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "graphics_pipeline/color.h"
@@ -0,0 +1,200 @@
+#include "graphics_pipeline/viewer.h"
+
+#include <iostream>
+
+#include "graphics_pipeline/color.h"
+#include "graphics_pipeline/profiler.h"
+
+Viewer *viewer;
+constexpr int FRAMEBUFFER_WIDTH = 640;
+constexpr int FRAMEBUFFER_HEIGHT = 480;
+constexpr int GUI_WIDTH = 400;
+constexpr int GUI_HEIGHT = 600;
+constexpr int DEFAULT_HEAT_MAP_MAX_COUNT = 4;
+
+Viewer::Viewer(int _width, int _height) {
+  show_heat_map = false;
+  heat_map_channel = Framebuffer::SHADED_FRAGMENTS;
+  heat_map_max_count = DEFAULT_HEAT_MAP_MAX_COUNT;
+  gui = new GUI(GUI_WIDTH, GUI_HEIGHT, "GUI");
+  window = new Window(_width, _height, "SW Framebuffer");
+  scene = new Scene(_width, _height);
+
+  glfwSetWindowUserPointer(window->window, this);
+  glfwSetKeyCallback(window->window, KeyCallback);
+  glfwSetMouseButtonCallback(window->window, MouseButtonCallback);
+  glfwSetCursorPosCallback(window->window, CursorPositionCallback);
+  glfwSetScrollCallback(window->window, ScrollCallback);
+  Profiler::SetEnabled(true);
+}
+
+Viewer::~Viewer() {
+  delete scene;
+  delete window;
+  delete gui;
+}
+
+void Viewer::Run() {
+  while ((glfwWindowShouldClose(window->window) == 0) && (glfwWindowShouldClose(gui->window) == 0)) {
+    glfwMakeContextCurrent(gui->window);
+    glClear(GL_COLOR_BUFFER_BIT);
+    gui->Render();
+    glfwSwapBuffers(gui->window);
+
+    glfwMakeContextCurrent(window->window);
+    glClear(GL_COLOR_BUFFER_BIT);
+    Framebuffer *framebuffer = scene->framebuffer;
+    if (show_heat_map && framebuffer->HasStatistics()) {
+      window->Present(framebuffer->width, framebuffer->height,
+                      framebuffer->ResolveHeatMap(heat_map_channel, heat_map_max_count));
+    } else {
+      window->Present(framebuffer);
+    }
+
+    glfwPollEvents();
+    Profiler::EndFrame();
+  }
+}
+
+void Viewer::KeyCallback(GLFWwindow *window, int key, int scan_code, int action, int mods) {
+  auto *viewer = static_cast<Viewer *>(glfwGetWindowUserPointer(window));
+  if (viewer != nullptr) {
+    viewer->HandleKeyInput(key, action, mods);
+  }
+}
+
+void Viewer::MouseButtonCallback(GLFWwindow *window, int button, int action, int mods) {
+  auto *viewer = static_cast<Viewer *>(glfwGetWindowUserPointer(window));
+  if (viewer != nullptr) {
+    viewer->HandleMouseButton(button, action, mods);
+  }
+}
+
+void Viewer::CursorPositionCallback(GLFWwindow *window, double u_coordinate, double v_coordinate) {
+  auto *viewer = static_cast<Viewer *>(glfwGetWindowUserPointer(window));
+  if (viewer != nullptr) {
+    viewer->HandleCursorPosition(u_coordinate, v_coordinate);
+  }
+}
+
+void Viewer::ScrollCallback(GLFWwindow *window, double u_offset, double v_offset) {
+  auto *viewer = static_cast<Viewer *>(glfwGetWindowUserPointer(window));
+  if (viewer != nullptr) {
+    viewer->HandleScroll(u_offset, v_offset);
+  }
+}
+
+void Viewer::HandleKeyInput(int key, int action, int mods) {
+  if (action != GLFW_PRESS && action != GLFW_REPEAT) {
+    return;
+  }
+
+  constexpr float TRANSLATION_STEP = 1.0F;
+  constexpr float ROTATION_STEP = 0.1F;
+  constexpr float ZOOM_FACTOR = 1.1F;
+
+  switch (key) {
+  case GLFW_KEY_W:
+    scene->camera->Translate(scene->camera->GetForward() * TRANSLATION_STEP);
+    break;
+  case GLFW_KEY_S:
+    scene->camera->Translate(scene->camera->GetForward() * (-TRANSLATION_STEP));
+    break;
+  case GLFW_KEY_A:
+    scene->camera->Translate(scene->camera->GetRight() * (-TRANSLATION_STEP));
+    break;
+  case GLFW_KEY_D:
+    scene->camera->Translate(scene->camera->GetRight() * TRANSLATION_STEP);
+    break;
+  case GLFW_KEY_Q:
+    scene->camera->Translate(scene->camera->GetUp() * (-TRANSLATION_STEP));
+    break;
+  case GLFW_KEY_E:
+    scene->camera->Translate(scene->camera->GetUp() * TRANSLATION_STEP);
+    break;
+  case GLFW_KEY_UP:
+    scene->camera->Tilt(-ROTATION_STEP);
+    break;
+  case GLFW_KEY_DOWN:
+    scene->camera->Tilt(ROTATION_STEP);
+    break;
+  case GLFW_KEY_LEFT:
+    scene->camera->Pan(ROTATION_STEP);
+    break;
+  case GLFW_KEY_RIGHT:
+    scene->camera->Pan(-ROTATION_STEP);
+    break;
+  case GLFW_KEY_Z:
+    scene->camera->Roll(-ROTATION_STEP);
+    break;
+  case GLFW_KEY_X:
+    scene->camera->Roll(ROTATION_STEP);
+    break;
+  case GLFW_KEY_EQUAL:
+    scene->camera->Zoom(ZOOM_FACTOR);
+    break;
+  case GLFW_KEY_MINUS:
+    scene->camera->Zoom(1.0F / ZOOM_FACTOR);
+    break;
+  default:
+    break;
+  }
+}
+
+void Viewer::HandleMouseButton(int button, int action, int mods) {
+  if (action == GLFW_PRESS) {
+    double u_coordinate;
+    double v_coordinate;
+    glfwGetCursorPos(window->window, &u_coordinate, &v_coordinate);
+
+    if (button == GLFW_MOUSE_BUTTON_LEFT) {
+      std::cout << "Left click at (" << u_coordinate << ", " << v_coordinate << ")" << '\n';
+    } else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
+      std::cout << "Right click at (" << u_coordinate << ", " << v_coordinate << ")" << '\n';
+    } else if (button == GLFW_MOUSE_BUTTON_MIDDLE) {
+      std::cout << "Middle click at (" << u_coordinate << ", " << v_coordinate << ")" << '\n';
+    }
+  }
+}
+
+void Viewer::HandleCursorPosition(double u_coordinate, double v_coordinate) {}
+
+void Viewer::HandleScroll(double u_offset, double v_offset) {}
+
+void Viewer::DBG() {
+  Framebuffer *framebuffer = scene->framebuffer;
+  constexpr int stepsN = 100;
+  for (int si = 0; si < stepsN; si++) {
+    framebuffer->FillBackground(Color::WHITE);
+
+    int v_coordinate = (framebuffer->height / 2) + si;
+    if (v_coordinate >= framebuffer->height) {
+      break;
+    }
+
+    for (int u_coordinate = stepsN; u_coordinate < stepsN * 2; u_coordinate++) {
+      framebuffer->SetPixel(u_coordinate, v_coordinate, Color::BLACK);
+    }
+
+    window->Present(framebuffer);
+    glfwPollEvents();
+  }
+
+  std::cerr << '\n';
+  std::cerr << "INFO: pressed DBG button on GUI" << '\n';
+}
+
+auto main(int argc, char *argv[]) -> int {
+  if (glfwInit() == 0) {
+    std::cerr << "Failed to initialize GLFW" << '\n';
+    return -1;
+  }
+
+  viewer = new Viewer(FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT);
+  viewer->Run();
+
+  delete viewer;
+  glfwTerminate();
+
+  return 0;
+}
\ No newline at end of file
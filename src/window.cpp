@@ -0,0 +1,37 @@
+#include "graphics_pipeline/window.h"
+
+#include "graphics_pipeline/profiler.h"
+
+Window::Window(int _width, int _height, const char *title) {
+  width = _width;
+  height = _height;
+
+  glfwWindowHint(GLFW_FLOATING, GLFW_TRUE);
+  glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+  glfwWindowHint(GLFW_DECORATED, GLFW_TRUE);
+  window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+  glfwMakeContextCurrent(window);
+
+  glewInit();
+}
+
+Window::~Window() { glfwDestroyWindow(window); }
+
+// The window follows the framebuffer size, which changes when a TIFF is loaded into it.
+void Window::Present(Framebuffer *framebuffer) {
+  Present(framebuffer->width, framebuffer->height, framebuffer->ResolvePixels());
+}
+
+void Window::Present(int _width, int _height, const unsigned int *pixels) {
+  Profiler::ScopedTimer timer(Profiler::PRESENT);
+  glfwMakeContextCurrent(window);
+  if (_width != width || _height != height) {
+    width = _width;
+    height = _height;
+    glfwSetWindowSize(window, width, height);
+  }
+
+  glDrawPixels(width, height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8, pixels);
+
+  glfwSwapBuffers(window);
+}
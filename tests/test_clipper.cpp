@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "graphics_pipeline/clipper.h"
+#include "graphics_pipeline/vector_3.h"
+
+// NOLINTBEGIN(readability-magic-numbers)
+
+// A 640x480 viewport with a 90 degree horizontal field of view, so a point at depth z is on the viewport's left or
+// right edge when |x| = z and on its top or bottom edge when |y| = 0.75 z.
+class ClipperTest : public ::testing::Test {
+protected:
+  static constexpr float EPSILON = 1e-4F;
+  static constexpr float FOCAL_LENGTH = 320.0F;
+  static constexpr float NEAR_DISTANCE = 0.1F;
+  Clipper clipper;
+
+  void SetUp() override { clipper.SetFrustum(FOCAL_LENGTH, 640, 480, NEAR_DISTANCE); }
+
+  static auto FloatEqual(float first_value, float second_value) -> bool {
+    return std::abs(first_value - second_value) < EPSILON;
+  }
+
+  static auto VectorEqual(Vector3 first_vector, Vector3 second_vector) -> bool {
+    return FloatEqual(first_vector[0], second_vector[0]) && FloatEqual(first_vector[1], second_vector[1]) &&
+           FloatEqual(first_vector[2], second_vector[2]);
+  }
+
+  // Source weights start as the identity, as DrawMeshFilled sets them.
+  static auto MakeTriangle(Vector3 point_0, Vector3 point_1, Vector3 point_2) -> std::array<Clipper::Vertex, 3> {
+    std::array<Clipper::Vertex, 3> ret;
+    std::array<Vector3, 3> points = {point_0, point_1, point_2};
+    for (int i = 0; i < 3; i++) {
+      ret[i].camera_point = points[i];
+      ret[i].color = Vector3(1.0F, 1.0F, 1.0F);
+      ret[i].source_weights = Vector3(i == 0 ? 1.0F : 0.0F, i == 1 ? 1.0F : 0.0F, i == 2 ? 1.0F : 0.0F);
+    }
+    return ret;
+  }
+
+  // Every clipped vertex must be the point its source weights give on the original triangle, with weights summing
+  // to one.
+  static void ExpectConsistentWeights(const std::array<Clipper::Vertex, 3> &triangle,
+                                      const Clipper::Polygon &polygon) {
+    std::array<Vector3, 3> points = {triangle[0].camera_point, triangle[1].camera_point, triangle[2].camera_point};
+    for (int i = 0; i < polygon.vertex_count; i++) {
+      Vector3 weights = polygon.vertices[i].source_weights;
+      Vector3 point = (points[0] * weights[0]) + (points[1] * weights[1]) + (points[2] * weights[2]);
+      EXPECT_TRUE(FloatEqual(weights[0] + weights[1] + weights[2], 1.0F)) << "vertex " << i;
+      EXPECT_TRUE(VectorEqual(polygon.vertices[i].camera_point, point)) << "vertex " << i;
+    }
+  }
+};
+
+TEST_F(ClipperTest, ClipFlags) {
+  EXPECT_EQ(clipper.GetClipFlags(Vector3(0.0F, 0.0F, 10.0F)), 0);
+  EXPECT_EQ(clipper.GetClipFlags(Vector3(-11.0F, 0.0F, 10.0F)), 1U << Clipper::LEFT);
+  EXPECT_EQ(clipper.GetClipFlags(Vector3(0.0F, 8.0F, 10.0F)), 1U << Clipper::TOP);
+  EXPECT_EQ(clipper.GetClipFlags(Vector3(-1000.0F, 0.0F, 10.0F)),
+            (1U << Clipper::LEFT) | (1U << (Clipper::PLANE_COUNT + Clipper::LEFT)));
+  EXPECT_EQ(clipper.GetClipFlags(Vector3(0.0F, 0.0F, 0.05F)),
+            (1U << Clipper::NEAR) | (1U << (Clipper::PLANE_COUNT + Clipper::NEAR)));
+}
+
+TEST_F(ClipperTest, AcceptsTriangleInsideViewport) {
+  auto triangle = MakeTriangle(Vector3(-1.0F, -1.0F, 10.0F), Vector3(1.0F, -1.0F, 10.0F), Vector3(0.0F, 1.0F, 10.0F));
+  Clipper::Polygon polygon;
+
+  EXPECT_EQ(clipper.ClipTriangle(triangle, polygon), Clipper::ACCEPTED);
+  ASSERT_EQ(polygon.vertex_count, 3);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(VectorEqual(polygon.vertices[i].camera_point, triangle[i].camera_point));
+    EXPECT_TRUE(VectorEqual(polygon.vertices[i].source_weights, triangle[i].source_weights));
+  }
+}
+
+TEST_F(ClipperTest, RejectsTriangleBehindNearPlane) {
+  auto triangle = MakeTriangle(Vector3(-1.0F, -1.0F, -1.0F), Vector3(1.0F, -1.0F, 0.05F), Vector3(0.0F, 1.0F, -2.0F));
+  Clipper::Polygon polygon;
+
+  EXPECT_EQ(clipper.ClipTriangle(triangle, polygon), Clipper::REJECTED);
+}
+
+// Only vertices outside the same plane reject a triangle; one whose vertices are outside different planes is kept.
+TEST_F(ClipperTest, RejectsTriangleOutsideOneSidePlane) {
+  auto outside_left =
+      MakeTriangle(Vector3(-20.0F, 0.0F, 10.0F), Vector3(-30.0F, 5.0F, 10.0F), Vector3(-15.0F, -5.0F, 10.0F));
+  auto outside_bottom =
+      MakeTriangle(Vector3(0.0F, -9.0F, 10.0F), Vector3(5.0F, -20.0F, 10.0F), Vector3(-5.0F, -9.0F, 10.0F));
+  auto across_corners =
+      MakeTriangle(Vector3(-20.0F, 0.0F, 10.0F), Vector3(20.0F, 0.0F, 10.0F), Vector3(0.0F, 20.0F, 10.0F));
+  Clipper::Polygon polygon;
+
+  EXPECT_EQ(clipper.ClipTriangle(outside_left, polygon), Clipper::REJECTED);
+  EXPECT_EQ(clipper.ClipTriangle(outside_bottom, polygon), Clipper::REJECTED);
+  EXPECT_EQ(clipper.ClipTriangle(across_corners, polygon), Clipper::ACCEPTED);
+}
+
+// Vertices outside the viewport but inside the guard band are left for the rasterizer to clamp.
+TEST_F(ClipperTest, PassesThroughTriangleInsideGuardBand) {
+  auto triangle =
+      MakeTriangle(Vector3(-100.0F, -80.0F, 10.0F), Vector3(100.0F, -80.0F, 10.0F), Vector3(0.0F, 80.0F, 10.0F));
+  Clipper::Polygon polygon;
+
+  EXPECT_EQ(clipper.ClipTriangle(triangle, polygon), Clipper::ACCEPTED);
+  EXPECT_EQ(polygon.vertex_count, 3);
+}
+
+TEST_F(ClipperTest, ClipsTriangleCrossingGuardBand) {
+  auto triangle = MakeTriangle(Vector3(-1000.0F, 0.0F, 10.0F), Vector3(1.0F, 0.0F, 10.0F), Vector3(0.0F, 1.0F, 10.0F));
+  Clipper::Polygon polygon;
+
+  EXPECT_EQ(clipper.ClipTriangle(triangle, polygon), Clipper::CLIPPED);
+  EXPECT_EQ(polygon.vertex_count, 4);
+  for (int i = 0; i < polygon.vertex_count; i++) {
+    EXPECT_GE(Clipper::GetDistance(clipper.guard_band_planes[Clipper::LEFT], polygon.vertices[i].camera_point),
+              -EPSILON);
+  }
+  ExpectConsistentWeights(triangle, polygon);
+}
+
+// One vertex behind the near plane cuts a corner off, leaving a quadrilateral; two leave a smaller triangle.
+TEST_F(ClipperTest, ClipsTriangleStraddlingNearPlane) {
+  auto one_behind = MakeTriangle(Vector3(-1.0F, 0.0F, 2.0F), Vector3(1.0F, 0.0F, 2.0F), Vector3(0.0F, 1.0F, -2.0F));
+  auto two_behind = MakeTriangle(Vector3(-1.0F, 0.0F, -2.0F), Vector3(1.0F, 0.0F, -2.0F), Vector3(0.0F, 1.0F, 2.0F));
+  Clipper::Polygon polygon;
+
+  EXPECT_EQ(clipper.ClipTriangle(one_behind, polygon), Clipper::CLIPPED);
+  EXPECT_EQ(polygon.vertex_count, 4);
+  for (int i = 0; i < polygon.vertex_count; i++) {
+    EXPECT_GE(polygon.vertices[i].camera_point[2], NEAR_DISTANCE - EPSILON);
+  }
+  ExpectConsistentWeights(one_behind, polygon);
+
+  EXPECT_EQ(clipper.ClipTriangle(two_behind, polygon), Clipper::CLIPPED);
+  EXPECT_EQ(polygon.vertex_count, 3);
+  int vertices_on_near_plane = 0;
+  for (int i = 0; i < polygon.vertex_count; i++) {
+    EXPECT_GE(polygon.vertices[i].camera_point[2], NEAR_DISTANCE - EPSILON);
+    vertices_on_near_plane += FloatEqual(polygon.vertices[i].camera_point[2], NEAR_DISTANCE) ? 1 : 0;
+  }
+  EXPECT_EQ(vertices_on_near_plane, 2);
+  ExpectConsistentWeights(two_behind, polygon);
+}
+
+// On the near plane the source weights interpolate linearly along the cut edges.
+TEST_F(ClipperTest, NearPlaneSourceWeights) {
+  auto triangle = MakeTriangle(Vector3(0.0F, 0.0F, -0.9F), Vector3(0.0F, 0.0F, 1.1F), Vector3(1.0F, 0.0F, 1.1F));
+  Clipper::Polygon polygon;
+
+  ASSERT_EQ(clipper.ClipTriangle(triangle, polygon), Clipper::CLIPPED);
+  ASSERT_EQ(polygon.vertex_count, 4);
+  bool has_midpoint_of_first_edge = false;
+  for (int i = 0; i < polygon.vertex_count; i++) {
+    has_midpoint_of_first_edge = has_midpoint_of_first_edge ||
+                                 VectorEqual(polygon.vertices[i].source_weights, Vector3(0.5F, 0.5F, 0.0F));
+  }
+  EXPECT_TRUE(has_midpoint_of_first_edge);
+}
+
+TEST_F(ClipperTest, PrecomputedFlagsMatch) {
+  auto triangle = MakeTriangle(Vector3(-1.0F, 0.0F, 2.0F), Vector3(1.0F, 0.0F, 2.0F), Vector3(0.0F, 1.0F, -2.0F));
+  std::array<std::uint16_t, 3> clip_flags;
+  for (int i = 0; i < 3; i++) {
+    clip_flags[i] = clipper.GetClipFlags(triangle[i].camera_point);
+  }
+  Clipper::Polygon polygon;
+  Clipper::Polygon flagged_polygon;
+
+  EXPECT_EQ(clipper.ClipTriangle(triangle, clip_flags, flagged_polygon), clipper.ClipTriangle(triangle, polygon));
+  ASSERT_EQ(flagged_polygon.vertex_count, polygon.vertex_count);
+  for (int i = 0; i < polygon.vertex_count; i++) {
+    EXPECT_TRUE(VectorEqual(flagged_polygon.vertices[i].camera_point, polygon.vertices[i].camera_point));
+  }
+}
+
+// NOLINTEND(readability-magic-numbers)
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "graphics_pipeline/culler.h"
+#include "graphics_pipeline/vector_3.h"
+
+// NOLINTBEGIN(readability-magic-numbers)
+
+// Screen coordinates have v pointing down, so these corners are clockwise on screen in this order.
+class CullerTest : public ::testing::Test {
+protected:
+  Vector3 top_left = Vector3(10.0F, 10.0F, 0.0F);
+  Vector3 top_right = Vector3(50.0F, 10.0F, 0.0F);
+  Vector3 bottom_left = Vector3(10.0F, 50.0F, 0.0F);
+};
+
+TEST_F(CullerTest, DefaultKeepsBothWindings) {
+  Culler culler;
+
+  EXPECT_EQ(culler.cull_mode, Culler::CULL_NONE);
+  EXPECT_EQ(culler.Test(top_left, top_right, bottom_left), Culler::VISIBLE);
+  EXPECT_EQ(culler.Test(top_left, bottom_left, top_right), Culler::VISIBLE);
+  EXPECT_EQ(culler.counters.tested, 2);
+  EXPECT_EQ(culler.counters.culled_facing, 0);
+}
+
+TEST_F(CullerTest, CullBackWithCounterClockwiseFrontFaces) {
+  Culler culler;
+  culler.cull_mode = Culler::CULL_BACK;
+  culler.front_face_winding = Culler::COUNTER_CLOCKWISE;
+
+  EXPECT_EQ(culler.Test(top_left, top_right, bottom_left), Culler::CULLED_FACING);
+  EXPECT_EQ(culler.Test(top_left, bottom_left, top_right), Culler::VISIBLE);
+  EXPECT_EQ(culler.counters.tested, 2);
+  EXPECT_EQ(culler.counters.culled_facing, 1);
+}
+
+TEST_F(CullerTest, CullBackWithClockwiseFrontFaces) {
+  Culler culler;
+  culler.cull_mode = Culler::CULL_BACK;
+  culler.front_face_winding = Culler::CLOCKWISE;
+
+  EXPECT_EQ(culler.Test(top_left, top_right, bottom_left), Culler::VISIBLE);
+  EXPECT_EQ(culler.Test(top_left, bottom_left, top_right), Culler::CULLED_FACING);
+  EXPECT_EQ(culler.counters.culled_facing, 1);
+}
+
+TEST_F(CullerTest, CullFront) {
+  Culler culler;
+  culler.cull_mode = Culler::CULL_FRONT;
+  culler.front_face_winding = Culler::COUNTER_CLOCKWISE;
+
+  EXPECT_EQ(culler.Test(top_left, top_right, bottom_left), Culler::VISIBLE);
+  EXPECT_EQ(culler.Test(top_left, bottom_left, top_right), Culler::CULLED_FACING);
+  EXPECT_EQ(culler.counters.culled_facing, 1);
+}
+
+TEST_F(CullerTest, FacingIgnoresDegenerateTriangles) {
+  Culler culler;
+  culler.cull_mode = Culler::CULL_BACK;
+
+  EXPECT_FALSE(culler.IsFacingCulled(top_left, top_right, Vector3(30.0F, 10.0F, 0.0F)));
+  EXPECT_TRUE(culler.IsFacingCulled(top_left, top_right, bottom_left));
+  EXPECT_EQ(culler.counters.tested, 0);
+}
+
+TEST_F(CullerTest, ZeroArea) {
+  Culler culler;
+
+  EXPECT_EQ(culler.Test(top_left, Vector3(30.0F, 30.0F, 0.0F), Vector3(50.0F, 50.0F, 0.0F)),
+            Culler::CULLED_ZERO_AREA);
+  EXPECT_EQ(culler.counters.culled_zero_area, 1);
+
+  culler.cull_zero_area = false;
+  EXPECT_EQ(culler.Test(top_left, Vector3(30.0F, 30.0F, 0.0F), Vector3(50.0F, 50.0F, 0.0F)), Culler::VISIBLE);
+  EXPECT_EQ(culler.counters.culled_zero_area, 1);
+}
+
+// The middle vertex is off the line by less than half a subpixel, so snapping makes the triangle collinear.
+TEST_F(CullerTest, ZeroAreaAfterSnapping) {
+  Culler culler;
+
+  EXPECT_EQ(culler.Test(top_left, Vector3(30.0F, 10.001F, 0.0F), top_right), Culler::CULLED_ZERO_AREA);
+  EXPECT_EQ(culler.Test(top_left, Vector3(30.0F, 10.01F, 0.0F), top_right), Culler::CULLED_NO_SAMPLES);
+}
+
+// Pixel centers are at half-integer coordinates; this triangle fits between them.
+TEST_F(CullerTest, NoSamples) {
+  Culler culler;
+  Vector3 point_0(10.6F, 10.6F, 0.0F);
+  Vector3 point_1(10.6F, 10.9F, 0.0F);
+  Vector3 point_2(10.9F, 10.6F, 0.0F);
+
+  EXPECT_EQ(culler.Test(point_0, point_1, point_2), Culler::CULLED_NO_SAMPLES);
+  EXPECT_EQ(culler.counters.culled_no_samples, 1);
+
+  culler.cull_no_samples = false;
+  EXPECT_EQ(culler.Test(point_0, point_1, point_2), Culler::VISIBLE);
+
+  culler.cull_no_samples = true;
+  EXPECT_EQ(culler.Test(Vector3(10.4F, 10.4F, 0.0F), Vector3(10.4F, 10.9F, 0.0F), Vector3(10.9F, 10.4F, 0.0F)),
+            Culler::VISIBLE);
+  EXPECT_EQ(culler.counters.culled_no_samples, 1);
+}
+
+TEST_F(CullerTest, FacingIsTestedFirst) {
+  Culler culler;
+  culler.cull_mode = Culler::CULL_BACK;
+  Vector3 point_0(10.6F, 10.6F, 0.0F);
+  Vector3 point_1(10.9F, 10.6F, 0.0F);
+  Vector3 point_2(10.6F, 10.9F, 0.0F);
+
+  EXPECT_EQ(culler.Test(point_0, point_1, point_2), Culler::CULLED_FACING);
+  EXPECT_EQ(culler.counters.culled_facing, 1);
+  EXPECT_EQ(culler.counters.culled_no_samples, 0);
+}
+
+TEST_F(CullerTest, UnsnappablePointsAreLeftToTheRasterizer) {
+  Culler culler;
+
+  EXPECT_EQ(culler.Test(top_left, Vector3(1e7F, 10.0F, 0.0F), Vector3(2e7F, 10.0F, 0.0F)), Culler::VISIBLE);
+}
+
+TEST_F(CullerTest, ResetCounters) {
+  Culler culler;
+  culler.cull_mode = Culler::CULL_BACK;
+  culler.Test(top_left, top_right, bottom_left);
+  culler.Test(top_left, top_right, Vector3(30.0F, 10.0F, 0.0F));
+
+  culler.ResetCounters();
+
+  EXPECT_EQ(culler.counters.tested, 0);
+  EXPECT_EQ(culler.counters.culled_facing, 0);
+  EXPECT_EQ(culler.counters.culled_zero_area, 0);
+  EXPECT_EQ(culler.counters.culled_no_samples, 0);
+}
+
+// NOLINTEND(readability-magic-numbers)
@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "graphics_pipeline/color.h"
+#include "graphics_pipeline/image_writer.h"
+#include "graphics_pipeline/scene.h"
+
+// NOLINTBEGIN(readability-magic-numbers)
+
+// Renders a fixed set of scenes headlessly and checks them three ways: against reference TIFFs in GOLDEN_DIRECTORY,
+// against the frame time budgets recorded next to them, and bit-exactly against the scalar, linear, single-threaded
+// rasterizer without hierarchical z. Running with UPDATE_GOLDEN_IMAGES=1 rewrites the references and budgets from the
+// current build instead of checking them.
+namespace {
+constexpr int WIDTH = 640;
+constexpr int HEIGHT = 480;
+constexpr unsigned int MESH_COLOR = 0xFF8040FF;
+// Channels may differ by this much, so that references survive compilers that contract floating point differently.
+constexpr int CHANNEL_TOLERANCE = 2;
+// Frame time is the median of this many frames, after one warm-up frame.
+constexpr int TIMED_FRAME_COUNT = 7;
+constexpr double DEFAULT_BUDGET_MARGIN = 0.5;
+constexpr const char *BUDGET_FILE_NAME = "budgets.txt";
+
+struct GoldenScene {
+  const char *name;
+  std::function<void(Scene &scene)> configure;
+  std::function<void(Scene &scene)> draw;
+};
+
+auto MakeCheckerTexture(int size, int square_size) -> std::shared_ptr<Texture> {
+  auto texture = std::make_shared<Texture>();
+  texture->width = size;
+  texture->height = size;
+  texture->pixels.resize(static_cast<long>(size) * size);
+  for (int v_coordinate = 0; v_coordinate < size; v_coordinate++) {
+    for (int u_coordinate = 0; u_coordinate < size; u_coordinate++) {
+      bool is_dark = ((u_coordinate / square_size) + (v_coordinate / square_size)) % 2 == 0;
+      texture->pixels[(static_cast<long>(v_coordinate) * size) + u_coordinate] = is_dark ? 0xFF303030 : 0xFFE0E0E0;
+    }
+  }
+  return texture;
+}
+
+// Red rises along u and green along v by one step per texel, so neighbouring texels differ by at most one level.
+auto MakeRampTexture(int size) -> std::shared_ptr<Texture> {
+  auto texture = std::make_shared<Texture>();
+  texture->width = size;
+  texture->height = size;
+  texture->pixels.resize(static_cast<long>(size) * size);
+  for (int v_coordinate = 0; v_coordinate < size; v_coordinate++) {
+    for (int u_coordinate = 0; u_coordinate < size; u_coordinate++) {
+      texture->pixels[(static_cast<long>(v_coordinate) * size) + u_coordinate] =
+          (static_cast<unsigned int>(u_coordinate) << Color::RED_SHIFT) |
+          (static_cast<unsigned int>(v_coordinate) << Color::GREEN_SHIFT) | (0x80U << Color::BLUE_SHIFT) |
+          Color::ALPHA_CHANNEL_MASK;
+    }
+  }
+  return texture;
+}
+
+auto DrawMesh(TriangleMesh mesh, bool use_lighting) -> std::function<void(Scene &scene)> {
+  return [mesh, use_lighting](Scene &scene) mutable { scene.DrawMeshFilled(&mesh, use_lighting); };
+}
+
+auto GetGoldenScenes() -> const std::vector<GoldenScene> & {
+  static const std::vector<GoldenScene> scenes = [] {
+    auto pose_front = [](Scene &scene) {
+      scene.camera->Pose(Vector3(3.0F, 2.0F, -40.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
+    };
+    auto pose_near = [](Scene &scene) {
+      scene.camera->Pose(Vector3(0.0F, 0.0F, -12.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
+    };
+    auto pose_axis = [](Scene &scene) {
+      scene.camera->Pose(Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 0.0F, 1.0F), Vector3(0.0F, 1.0F, 0.0F));
+    };
+
+    TriangleMesh sphere = TriangleMesh::Sphere(Vector3(0.0F, 0.0F, 0.0F), 10.0F, 6, MESH_COLOR);
+    TriangleMesh box =
+        TriangleMesh::AxisAlignedBox(Vector3(-8.0F, -8.0F, -8.0F), Vector3(8.0F, 8.0F, 8.0F), MESH_COLOR);
+    TriangleMesh cylinder = TriangleMesh::Cylinder(Vector3(0.0F, 0.0F, 0.0F), 6.0F, 20.0F, 32, MESH_COLOR);
+    std::shared_ptr<Texture> texture = MakeCheckerTexture(256, 16);
+    TriangleMesh quad = TriangleMesh::Quad(Vector3(0.0F, 0.0F, 20.0F), Vector3(0.3F, 0.0F, -1.0F),
+                                           Vector3(0.0F, 1.0F, 0.0F), 24.0F, 18.0F);
+    quad.texture = texture.get();
+
+    return std::vector<GoldenScene>{
+        {"sphere_lit", pose_front, DrawMesh(sphere, true)},
+        {"sphere_unlit", pose_front, DrawMesh(sphere, false)},
+        {"sphere_near_clipped", pose_near, DrawMesh(sphere, true)},
+        {"box_lit", pose_front, DrawMesh(box, true)},
+        {"cylinder_lit", pose_front, DrawMesh(cylinder, true)},
+        // The lambda keeps the texture alive.
+        {"quad_textured_visibility",
+         [pose_axis](Scene &scene) {
+           pose_axis(scene);
+           scene.use_visibility_buffer = true;
+         },
+         [quad, texture](Scene &scene) mutable { scene.DrawMeshFilled(&quad, false); }},
+    };
+  }();
+  return scenes;
+}
+
+auto GetGoldenPath(const std::string &file_name) -> std::string {
+  return (std::filesystem::path(GOLDEN_DIRECTORY) / file_name).string();
+}
+
+auto IsUpdating() -> bool {
+  const char *value = std::getenv("UPDATE_GOLDEN_IMAGES");
+  return value != nullptr && std::string(value) == "1";
+}
+
+auto GetBudgetMargin() -> double {
+  const char *value = std::getenv("PERFORMANCE_BUDGET_MARGIN");
+  return value != nullptr ? std::atof(value) : DEFAULT_BUDGET_MARGIN;
+}
+
+// One "scene_name milliseconds" pair per line.
+auto LoadBudgets() -> std::map<std::string, double> {
+  std::map<std::string, double> ret;
+  std::ifstream input(GetGoldenPath(BUDGET_FILE_NAME));
+  std::string name;
+  double milliseconds;
+  while (input >> name >> milliseconds) {
+    ret[name] = milliseconds;
+  }
+  return ret;
+}
+
+void SaveBudgets(const std::map<std::string, double> &budgets) {
+  std::ofstream output(GetGoldenPath(BUDGET_FILE_NAME));
+  for (const auto &[name, milliseconds] : budgets) {
+    output << name << " " << milliseconds << '\n';
+  }
+}
+
+auto RenderFrame(Scene &scene, const GoldenScene &golden_scene) -> std::vector<unsigned int> {
+  scene.framebuffer->FillBackground(Color::BLACK);
+  golden_scene.draw(scene);
+  const unsigned int *pixels = scene.framebuffer->ResolvePixels();
+  return {pixels, pixels + (static_cast<long>(WIDTH) * HEIGHT)};
+}
+
+// The pixels that differ, with the first of them described for the failure message.
+auto CountMismatches(const std::vector<unsigned int> &actual, const std::vector<unsigned int> &expected,
+                     int channel_tolerance, std::string &first_mismatch) -> long {
+  long ret = 0;
+  for (long i = 0; i < static_cast<long>(actual.size()); i++) {
+    bool is_within_tolerance = true;
+    for (int shift = 0; shift < 32; shift += 8) {
+      int actual_channel = static_cast<int>((actual[i] >> shift) & Color::ALPHA_CHANNEL_MASK);
+      int expected_channel = static_cast<int>((expected[i] >> shift) & Color::ALPHA_CHANNEL_MASK);
+      is_within_tolerance = is_within_tolerance && std::abs(actual_channel - expected_channel) <= channel_tolerance;
+    }
+    if (is_within_tolerance) {
+      continue;
+    }
+
+    if (ret == 0) {
+      first_mismatch = "pixel " + std::to_string(i % WIDTH) + ", " + std::to_string(i / WIDTH) + " from the top";
+    }
+    ret++;
+  }
+  return ret;
+}
+
+class GoldenImageTest : public ::testing::TestWithParam<int> {
+protected:
+  auto GetScene() -> const GoldenScene & { return GetGoldenScenes()[GetParam()]; }
+};
+
+TEST_P(GoldenImageTest, MatchesReferenceImage) {
+  const GoldenScene &golden_scene = GetScene();
+  Scene scene(WIDTH, HEIGHT);
+  golden_scene.configure(scene);
+  std::vector<unsigned int> actual = RenderFrame(scene, golden_scene);
+
+  std::string path = GetGoldenPath(std::string(golden_scene.name) + ".tif");
+  if (IsUpdating()) {
+    ASSERT_TRUE(ImageWriter::Write(path.c_str(), WIDTH, HEIGHT, actual.data(), ImageWriter::LZW,
+                                   ImageWriter::DEFAULT_ROWS_PER_STRIP, nullptr));
+    return;
+  }
+
+  ASSERT_TRUE(std::filesystem::exists(path)) << path << " is missing; run with UPDATE_GOLDEN_IMAGES=1 to create it";
+  Framebuffer reference(1, 1);
+  reference.LoadTiff(path.data());
+  ASSERT_EQ(reference.width, WIDTH);
+  ASSERT_EQ(reference.height, HEIGHT);
+  const unsigned int *reference_pixels = reference.ResolvePixels();
+  std::vector<unsigned int> expected(reference_pixels, reference_pixels + (static_cast<long>(WIDTH) * HEIGHT));
+
+  std::string first_mismatch;
+  EXPECT_EQ(CountMismatches(actual, expected, CHANNEL_TOLERANCE, first_mismatch), 0)
+      << "first at " << first_mismatch;
+}
+
+// Budgets hold for optimized builds on the machine that recorded them; PERFORMANCE_BUDGET_MARGIN is the fraction a
+// frame may exceed its budget by.
+TEST_P(GoldenImageTest, StaysWithinFrameBudget) {
+#ifndef NDEBUG
+  GTEST_SKIP() << "Frame budgets apply to optimized builds only";
+#endif
+  const GoldenScene &golden_scene = GetScene();
+  Scene scene(WIDTH, HEIGHT);
+  golden_scene.configure(scene);
+  RenderFrame(scene, golden_scene);
+
+  std::vector<double> frame_times;
+  for (int i = 0; i < TIMED_FRAME_COUNT; i++) {
+    auto start = std::chrono::steady_clock::now();
+    RenderFrame(scene, golden_scene);
+    frame_times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+  std::ranges::nth_element(frame_times, frame_times.begin() + (TIMED_FRAME_COUNT / 2));
+  double frame_time = frame_times[TIMED_FRAME_COUNT / 2];
+
+  std::map<std::string, double> budgets = LoadBudgets();
+  if (IsUpdating()) {
+    budgets[golden_scene.name] = frame_time;
+    SaveBudgets(budgets);
+    return;
+  }
+
+  ASSERT_TRUE(budgets.contains(golden_scene.name))
+      << golden_scene.name << " has no budget; run with UPDATE_GOLDEN_IMAGES=1 to record it";
+  double limit = budgets[golden_scene.name] * (1.0 + GetBudgetMargin());
+  EXPECT_LE(frame_time, limit) << "budget " << budgets[golden_scene.name] << " ms";
+}
+
+// In every depth format, every instruction set the CPU supports, both memory layouts, hierarchical z and tiled
+// multithreaded rasterization must reproduce the reference configuration in that format exactly.
+TEST_P(GoldenImageTest, OptimizedPathsMatchReference) {
+  const GoldenScene &golden_scene = GetScene();
+  SpanKernels::InstructionSet supported_instruction_set = SpanKernels::GetSupportedInstructionSet();
+
+  for (auto depth_format : {SpanKernels::DEPTH_FLOAT32, SpanKernels::DEPTH_UNORM24, SpanKernels::DEPTH_UNORM16}) {
+    SpanKernels::SetInstructionSet(SpanKernels::SCALAR);
+    Scene reference_scene(WIDTH, HEIGHT, 1);
+    reference_scene.framebuffer->SetDepthFormat(depth_format);
+    reference_scene.framebuffer->use_hierarchical_z = false;
+    golden_scene.configure(reference_scene);
+    std::vector<unsigned int> expected = RenderFrame(reference_scene, golden_scene);
+
+    for (int instruction_set = SpanKernels::SCALAR; instruction_set <= supported_instruction_set; instruction_set++) {
+      for (auto layout : {Framebuffer::LINEAR, Framebuffer::TILED}) {
+        for (bool use_hierarchical_z : {false, true}) {
+          for (int thread_count : {1, 4}) {
+            SpanKernels::SetInstructionSet(static_cast<SpanKernels::InstructionSet>(instruction_set));
+            Scene scene(WIDTH, HEIGHT, thread_count);
+            scene.framebuffer->SetDepthFormat(depth_format);
+            scene.framebuffer->SetMemoryLayout(layout);
+            scene.framebuffer->use_hierarchical_z = use_hierarchical_z;
+            golden_scene.configure(scene);
+            std::vector<unsigned int> actual = RenderFrame(scene, golden_scene);
+
+            std::string first_mismatch;
+            EXPECT_EQ(CountMismatches(actual, expected, 0, first_mismatch), 0)
+                << "depth format " << static_cast<int>(depth_format) << ", instruction set " << instruction_set
+                << ", layout " << static_cast<int>(layout) << ", hierarchical z " << use_hierarchical_z << ", "
+                << thread_count << " threads; first at " << first_mismatch;
+          }
+        }
+      }
+    }
+  }
+  SpanKernels::SetInstructionSet(supported_instruction_set);
+}
+
+INSTANTIATE_TEST_SUITE_P(Scenes, GoldenImageTest,
+                         ::testing::Range(0, static_cast<int>(GetGoldenScenes().size())),
+                         [](const ::testing::TestParamInfo<int> &info) { return GetGoldenScenes()[info.param].name; });
+
+// Both paths shade through the same fragment shader, so they may only differ by how they interpolate: a color channel
+// or a texel. The quad is lit, textured and cut by the near plane.
+TEST(ShadingPathTest, ForwardMatchesVisibilityBuffer) {
+  std::shared_ptr<Texture> texture = MakeRampTexture(256);
+  TriangleMesh quad = TriangleMesh::Quad(Vector3(0.0F, 0.0F, 8.0F), Vector3(2.0F, 0.0F, -1.0F),
+                                         Vector3(0.0F, 1.0F, 0.0F), 24.0F, 18.0F);
+  quad.texture = texture.get();
+
+  std::vector<std::vector<unsigned int>> images;
+  for (bool use_visibility_buffer : {false, true}) {
+    Scene scene(WIDTH, HEIGHT);
+    scene.camera->Pose(Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 0.0F, 1.0F), Vector3(0.0F, 1.0F, 0.0F));
+    scene.use_visibility_buffer = use_visibility_buffer;
+    images.push_back(RenderFrame(scene, {"quad", [](Scene &) {}, DrawMesh(quad, true)}));
+  }
+
+  long covered_count = std::ranges::count_if(images[0], [](unsigned int color) { return color != Color::BLACK; });
+  EXPECT_GT(covered_count, WIDTH * HEIGHT / 4);
+  std::string first_mismatch;
+  EXPECT_EQ(CountMismatches(images[0], images[1], CHANNEL_TOLERANCE, first_mismatch), 0)
+      << "first at " << first_mismatch;
+}
+} // namespace
+
+// NOLINTEND(readability-magic-numbers)
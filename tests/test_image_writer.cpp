@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "graphics_pipeline/framebuffer.h"
+#include "graphics_pipeline/image_writer.h"
+
+// NOLINTBEGIN(readability-magic-numbers)
+
+// The strip height does not divide the image height, so the last strip is short. The upper half is noise, which fills
+// the LZW table and forces clear codes within a strip; the lower half is a gradient with long repeated runs.
+class ImageWriterTest : public ::testing::Test {
+protected:
+  static constexpr int WIDTH = 300;
+  static constexpr int HEIGHT = 203;
+  static constexpr int ROWS_PER_STRIP = 16;
+  Framebuffer framebuffer = Framebuffer(WIDTH, HEIGHT);
+
+  void SetUp() override {
+    std::uint32_t state = 12345;
+    for (int v = 0; v < HEIGHT; v++) {
+      for (int u = 0; u < WIDTH; u++) {
+        state = (state * 1664525U) + 1013904223U;
+        unsigned int gradient = (static_cast<unsigned int>(u / 4) << 24) | (static_cast<unsigned int>(v) << 8) | 0xFF;
+        framebuffer.SetPixel(u, v, v < HEIGHT / 2 ? state : gradient);
+      }
+    }
+  }
+
+  static auto GetPath(const std::string &name) -> std::string {
+    return (std::filesystem::temp_directory_path() / ("image_writer_test_" + name + ".tif")).string();
+  }
+
+  // Reads the file back and counts the pixels that differ from the framebuffer.
+  auto CountMismatches(const std::string &path) -> long {
+    Framebuffer loaded(1, 1);
+    loaded.LoadTiff(const_cast<char *>(path.c_str()));
+    std::filesystem::remove(path);
+    if (loaded.width != WIDTH || loaded.height != HEIGHT) {
+      return -1;
+    }
+
+    const unsigned int *expected = framebuffer.ResolvePixels();
+    const unsigned int *actual = loaded.ResolvePixels();
+    long ret = 0;
+    for (long i = 0; i < static_cast<long>(WIDTH) * HEIGHT; i++) {
+      ret += actual[i] != expected[i] ? 1 : 0;
+    }
+    return ret;
+  }
+};
+
+TEST_F(ImageWriterTest, WriteRoundTrips) {
+  ThreadPool thread_pool(4);
+  for (auto compression : {ImageWriter::UNCOMPRESSED, ImageWriter::LZW, ImageWriter::DEFLATE}) {
+    for (ThreadPool *pool : {static_cast<ThreadPool *>(nullptr), &thread_pool}) {
+      std::string path = GetPath("write");
+      ASSERT_TRUE(ImageWriter::Write(path.c_str(), WIDTH, HEIGHT, framebuffer.ResolvePixels(), compression,
+                                     ROWS_PER_STRIP, pool));
+      EXPECT_EQ(CountMismatches(path), 0) << "compression " << static_cast<int>(compression);
+    }
+  }
+}
+
+TEST_F(ImageWriterTest, SubmitRoundTrips) {
+  ImageWriter image_writer(4);
+  image_writer.rows_per_strip = ROWS_PER_STRIP;
+  for (auto compression : {ImageWriter::UNCOMPRESSED, ImageWriter::LZW, ImageWriter::DEFLATE}) {
+    image_writer.compression = compression;
+    std::string path = GetPath("submit_" + std::to_string(static_cast<int>(compression)));
+    image_writer.Submit(&framebuffer, path);
+    ASSERT_TRUE(image_writer.Flush());
+    EXPECT_EQ(CountMismatches(path), 0) << "compression " << static_cast<int>(compression);
+  }
+}
+
+TEST_F(ImageWriterTest, FlushReportsFailedWrites) {
+  ImageWriter image_writer(1);
+  std::string path = GetPath("flush");
+  std::filesystem::path missing_path = std::filesystem::temp_directory_path() / "missing_directory" / "image.tif";
+  image_writer.Submit(&framebuffer, missing_path.string());
+  image_writer.Submit(&framebuffer, path);
+  EXPECT_FALSE(image_writer.Flush());
+  EXPECT_EQ(CountMismatches(path), 0);
+
+  // A failure is reported once
+  image_writer.Submit(&framebuffer, path);
+  EXPECT_TRUE(image_writer.Flush());
+  std::filesystem::remove(path);
+}
+
+// NOLINTEND(readability-magic-numbers)
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "graphics_pipeline/line_setup.h"
+#include "graphics_pipeline/vector_3.h"
+
+// NOLINTBEGIN(readability-magic-numbers)
+
+// The framebuffer clip is offset from the origin so that both signs of every coordinate are tested. The huge clip
+// contains every endpoint, so walking with it visits every pixel of the unclipped segment.
+class LineSetupTest : public ::testing::Test {
+protected:
+  using Pixels = std::vector<std::pair<int, int>>;
+  static constexpr ClipRectangle FRAMEBUFFER_CLIP = {3, 5, 100, 60};
+  static constexpr ClipRectangle HUGE_CLIP = {-1000000, -1000000, 1000000, 1000000};
+
+  static auto IsInside(ClipRectangle clip, int u_coordinate, int v_coordinate) -> bool {
+    return u_coordinate >= clip.min_u && u_coordinate <= clip.max_u && v_coordinate >= clip.min_v &&
+           v_coordinate <= clip.max_v;
+  }
+
+  // The pixels of the walk that are inside filter, in walk order.
+  static auto Walk(Vector3 start_point, Vector3 end_point, ClipRectangle clip, ClipRectangle filter) -> Pixels {
+    Pixels ret;
+    LineSetup setup;
+    if (setup.Initialize(start_point, end_point, clip)) {
+      setup.Walk([&](int u_coordinate, int v_coordinate, std::int64_t) {
+        if (IsInside(filter, u_coordinate, v_coordinate)) {
+          ret.emplace_back(u_coordinate, v_coordinate);
+        }
+      });
+    }
+    return ret;
+  }
+
+  static void ExpectClippedWalkMatches(Vector3 start_point, Vector3 end_point) {
+    Pixels clipped = Walk(start_point, end_point, FRAMEBUFFER_CLIP, HUGE_CLIP);
+    Pixels filtered = Walk(start_point, end_point, HUGE_CLIP, FRAMEBUFFER_CLIP);
+    for (auto [u_coordinate, v_coordinate] : clipped) {
+      EXPECT_TRUE(IsInside(FRAMEBUFFER_CLIP, u_coordinate, v_coordinate)) << u_coordinate << ", " << v_coordinate;
+    }
+    EXPECT_EQ(clipped, filtered) << "(" << start_point[0] << ", " << start_point[1] << ") to (" << end_point[0]
+                                 << ", " << end_point[1] << ")";
+  }
+};
+
+TEST_F(LineSetupTest, ClippedWalkMatchesUnclippedWalk) {
+  std::mt19937 generator(1);
+  for (float extent : {60.0F, 300.0F, 5000.0F}) {
+    std::uniform_real_distribution<float> coordinate(-extent, extent);
+    std::uniform_real_distribution<float> offset(-2.0F, 2.0F);
+    for (int i = 0; i < 2000; i++) {
+      Vector3 start_point(coordinate(generator), coordinate(generator), 0.0F);
+      Vector3 end_point(coordinate(generator), coordinate(generator), 0.0F);
+      ExpectClippedWalkMatches(start_point, end_point);
+
+      // Steep and near vertical, and near horizontal
+      Vector3 steep_end_point(start_point[0] + offset(generator), end_point[1], 0.0F);
+      ExpectClippedWalkMatches(start_point, steep_end_point);
+      Vector3 flat_end_point(end_point[0], start_point[1] + offset(generator), 0.0F);
+      ExpectClippedWalkMatches(start_point, flat_end_point);
+    }
+  }
+}
+
+TEST_F(LineSetupTest, AxisAlignedAndShortSegments) {
+  ExpectClippedWalkMatches(Vector3(50.5F, -400.0F, 0.0F), Vector3(50.5F, 400.0F, 0.0F));
+  ExpectClippedWalkMatches(Vector3(-400.0F, 20.5F, 0.0F), Vector3(400.0F, 20.5F, 0.0F));
+  ExpectClippedWalkMatches(Vector3(-400.0F, -400.0F, 0.0F), Vector3(400.0F, 400.0F, 0.0F));
+  ExpectClippedWalkMatches(Vector3(40.2F, 30.7F, 0.0F), Vector3(40.6F, 30.9F, 0.0F));
+  ExpectClippedWalkMatches(Vector3(2.9F, 4.9F, 0.0F), Vector3(3.1F, 5.1F, 0.0F));
+}
+
+TEST_F(LineSetupTest, RejectsSegmentOutsideClip) {
+  LineSetup setup;
+
+  EXPECT_FALSE(setup.Initialize(Vector3(-50.0F, 0.0F, 0.0F), Vector3(-10.0F, 200.0F, 0.0F), FRAMEBUFFER_CLIP));
+  EXPECT_FALSE(setup.Initialize(Vector3(0.0F, 200.0F, 0.0F), Vector3(200.0F, 100.0F, 0.0F), FRAMEBUFFER_CLIP));
+}
+
+// NOLINTEND(readability-magic-numbers)
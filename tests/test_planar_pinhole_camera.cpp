@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <vector>
 
 #include "graphics_pipeline/planar_pinhole_camera.h"
 #include "graphics_pipeline/vector_3.h"
@@ -29,9 +30,9 @@ TEST_F(PlanarPinholeCameraTest, DefaultConstructor) {
 TEST_F(PlanarPinholeCameraTest, ParameterizedConstructor) {
   PlanarPinholeCamera camera(640, 480, M_PI / 3.0F);
 
-  EXPECT_EQ(camera.width, 640);
-  EXPECT_EQ(camera.height, 480);
-  EXPECT_TRUE(FloatEqual(camera.horizontal_fov, M_PI / 3.0F));
+  EXPECT_EQ(camera.GetWidth(), 640);
+  EXPECT_EQ(camera.GetHeight(), 480);
+  EXPECT_TRUE(FloatEqual(camera.GetHorizontalFov(), M_PI / 3.0F));
 }
 
 TEST_F(PlanarPinholeCameraTest, GetSetHorizontalFov) {
@@ -74,33 +75,33 @@ TEST_F(PlanarPinholeCameraTest, Pan) {
   PlanarPinholeCamera camera(640, 480, M_PI / 3.0F);
   camera.Pose(Vector3(0.0F, 0.0F, 5.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
 
-  Vector3 initial_forward = camera.forward;
+  Vector3 initial_forward = camera.GetForward();
   camera.Pan(M_PI / 4.0F);
 
   // Forward vector should have changed
-  EXPECT_FALSE(VectorEqual(camera.forward, initial_forward));
+  EXPECT_FALSE(VectorEqual(camera.GetForward(), initial_forward));
 }
 
 TEST_F(PlanarPinholeCameraTest, Tilt) {
   PlanarPinholeCamera camera(640, 480, M_PI / 3.0F);
   camera.Pose(Vector3(0.0F, 0.0F, 5.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
 
-  Vector3 initial_forward = camera.forward;
+  Vector3 initial_forward = camera.GetForward();
   camera.Tilt(M_PI / 4.0F);
 
   // Forward vector should have changed
-  EXPECT_FALSE(VectorEqual(camera.forward, initial_forward));
+  EXPECT_FALSE(VectorEqual(camera.GetForward(), initial_forward));
 }
 
 TEST_F(PlanarPinholeCameraTest, Roll) {
   PlanarPinholeCamera camera(640, 480, M_PI / 3.0F);
   camera.Pose(Vector3(0.0F, 0.0F, 5.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
 
-  Vector3 initial_up = camera.up;
+  Vector3 initial_up = camera.GetUp();
   camera.Roll(M_PI / 4.0F);
 
   // Up vector should have changed
-  EXPECT_FALSE(VectorEqual(camera.up, initial_up));
+  EXPECT_FALSE(VectorEqual(camera.GetUp(), initial_up));
 }
 
 TEST_F(PlanarPinholeCameraTest, Zoom) {
@@ -121,7 +122,7 @@ TEST_F(PlanarPinholeCameraTest, GetViewDirection) {
 
   // View direction should be normalized and equal to forward
   EXPECT_TRUE(FloatEqual(view_direction.GetMagnitude(), 1.0F));
-  EXPECT_TRUE(VectorEqual(view_direction, camera.forward));
+  EXPECT_TRUE(VectorEqual(view_direction, camera.GetForward()));
 
   // Should point toward negative Z (from (0,0,5) to (0,0,0))
   EXPECT_LT(view_direction[2], 0.0F);
@@ -139,7 +140,7 @@ TEST_F(PlanarPinholeCameraTest, GetFocalLength) {
   EXPECT_GT(focal_length, 0.0F);
 
   // For a given width and FOV, focal length follows pinhole camera formula
-  float expected_focal_length = ((float)camera.width / 2.0F) / std::tan(camera.horizontal_fov / 2.0F);
+  float expected_focal_length = ((float)camera.GetWidth() / 2.0F) / std::tan(camera.GetHorizontalFov() / 2.0F);
   EXPECT_TRUE(FloatEqual(focal_length, expected_focal_length));
 }
 
@@ -157,9 +158,9 @@ TEST_F(PlanarPinholeCameraTest, ProjectUnproject) {
 
   // Projected point should be within image bounds (approximately)
   EXPECT_GE(projected_point[0], 0.0F);
-  EXPECT_LT(projected_point[0], camera.width);
+  EXPECT_LT(projected_point[0], camera.GetWidth());
   EXPECT_GE(projected_point[1], 0.0F);
-  EXPECT_LT(projected_point[1], camera.height);
+  EXPECT_LT(projected_point[1], camera.GetHeight());
 }
 
 TEST_F(PlanarPinholeCameraTest, UnprojectCenterPixel) {
@@ -167,8 +168,8 @@ TEST_F(PlanarPinholeCameraTest, UnprojectCenterPixel) {
   camera.Pose(Vector3(0.0F, 0.0F, 5.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
 
   // Unproject the center pixel
-  int u_coordinate = camera.width / 2;
-  int v_coordinate = camera.height / 2;
+  int u_coordinate = camera.GetWidth() / 2;
+  int v_coordinate = camera.GetHeight() / 2;
   float inverse_depth = 0.2F; // depth = 5 units (1/0.2 = 5)
 
   Vector3 unprojected_point = camera.Unproject(u_coordinate, v_coordinate, inverse_depth);
@@ -192,23 +193,97 @@ TEST_F(PlanarPinholeCameraTest, ProjectBehindCamera) {
   EXPECT_EQ(projection_result, 0);
 }
 
+TEST_F(PlanarPinholeCameraTest, GetCameraSpacePoint) {
+  PlanarPinholeCamera camera(640, 480, M_PI / 3.0F);
+  camera.Pose(Vector3(0.0F, 0.0F, 5.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
+
+  // The look-at point lies straight ahead; a point behind the camera has negative depth
+  Vector3 ahead = camera.GetCameraSpacePoint(Vector3(0.0F, 0.0F, 0.0F));
+  Vector3 behind = camera.GetCameraSpacePoint(Vector3(0.0F, 0.0F, 10.0F));
+
+  EXPECT_TRUE(VectorEqual(ahead, Vector3(0.0F, 0.0F, 5.0F)));
+  EXPECT_TRUE(VectorEqual(behind, Vector3(0.0F, 0.0F, -5.0F)));
+}
+
 TEST_F(PlanarPinholeCameraTest, OrthogonalBasisVectors) {
   PlanarPinholeCamera camera(640, 480, M_PI / 3.0F);
   camera.Pose(Vector3(0.0F, 0.0F, 5.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
 
   // After the fix, right, up, and forward should all be orthonormal unit vectors
-  float dot_product_right_up = camera.right.Dot(camera.up);
-  float dot_product_right_forward = camera.right.Dot(camera.forward);
-  float dot_product_up_forward = camera.up.Dot(camera.forward);
+  float dot_product_right_up = camera.GetRight().Dot(camera.GetUp());
+  float dot_product_right_forward = camera.GetRight().Dot(camera.GetForward());
+  float dot_product_up_forward = camera.GetUp().Dot(camera.GetForward());
 
   EXPECT_TRUE(FloatEqual(dot_product_right_up, 0.0F));
   EXPECT_TRUE(FloatEqual(dot_product_right_forward, 0.0F));
   EXPECT_TRUE(FloatEqual(dot_product_up_forward, 0.0F));
 
   // All should be unit vectors
-  EXPECT_TRUE(FloatEqual(camera.right.GetMagnitude(), 1.0F));
-  EXPECT_TRUE(FloatEqual(camera.up.GetMagnitude(), 1.0F));
-  EXPECT_TRUE(FloatEqual(camera.forward.GetMagnitude(), 1.0F));
+  EXPECT_TRUE(FloatEqual(camera.GetRight().GetMagnitude(), 1.0F));
+  EXPECT_TRUE(FloatEqual(camera.GetUp().GetMagnitude(), 1.0F));
+  EXPECT_TRUE(FloatEqual(camera.GetForward().GetMagnitude(), 1.0F));
+}
+
+TEST_F(PlanarPinholeCameraTest, CachedTransformFollowsCameraChanges) {
+  PlanarPinholeCamera camera(640, 480, M_PI / 3.0F);
+  camera.Pose(Vector3(0.0F, 0.0F, 5.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
+  Vector3 point(1.0F, 2.0F, -3.0F);
+  float focal_length = camera.GetFocalLength();
+  camera.GetCameraSpacePoint(point);
+
+  // Each change must be visible through the cache, matching a camera set up from scratch
+  camera.Pan(0.2F);
+  camera.Tilt(-0.1F);
+  camera.Roll(0.3F);
+  camera.Zoom(2.0F);
+  PlanarPinholeCamera fresh_camera(640, 480, camera.GetHorizontalFov());
+  fresh_camera.SetBasis(camera.GetRight(), camera.GetUp(), camera.GetForward());
+  fresh_camera.position = camera.position;
+
+  EXPECT_TRUE(VectorEqual(camera.GetCameraSpacePoint(point), fresh_camera.GetCameraSpacePoint(point)));
+  EXPECT_TRUE(FloatEqual(camera.GetFocalLength(), fresh_camera.GetFocalLength()));
+  EXPECT_FALSE(FloatEqual(camera.GetFocalLength(), focal_length));
+
+  // Resizing a camera whose transform is already cached
+  float zoomed_focal_length = camera.GetFocalLength();
+  camera.SetSize(320, 240);
+  EXPECT_TRUE(FloatEqual(camera.GetFocalLength(), zoomed_focal_length * 0.5F));
+  PlanarPinholeCamera small_camera(320, 240, camera.GetHorizontalFov());
+  EXPECT_TRUE(FloatEqual(camera.GetFocalLength(), small_camera.GetFocalLength()));
+
+  // Setting the basis directly
+  camera.SetBasis(Vector3(0.0F, 0.0F, -1.0F), Vector3(0.0F, 1.0F, 0.0F), Vector3(-1.0F, 0.0F, 0.0F));
+  camera.position = Vector3(0.0F, 0.0F, 0.0F);
+  EXPECT_TRUE(VectorEqual(camera.GetCameraSpacePoint(point), Vector3(3.0F, 2.0F, -1.0F)));
+}
+
+TEST_F(PlanarPinholeCameraTest, ProjectPointsMatchesProject) {
+  PlanarPinholeCamera camera(640, 480, M_PI / 3.0F);
+  camera.Pose(Vector3(2.0F, 1.0F, -20.0F), Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 1.0F, 0.0F));
+  std::vector<Vector3> points = {Vector3(0.0F, 0.0F, 0.0F), Vector3(5.0F, -3.0F, 4.0F), Vector3(-7.0F, 2.0F, -1.0F),
+                                 Vector3(2.0F, 1.0F, -30.0F)};
+
+  std::vector<Vector3> screen_points;
+  std::vector<unsigned char> is_projected;
+  camera.ProjectPoints(points, screen_points, is_projected);
+
+  ASSERT_EQ(screen_points.size(), points.size());
+  float focal_length = camera.GetFocalLength();
+  for (int i = 0; i < static_cast<int>(points.size()); i++) {
+    Vector3 projected_point;
+    int projection_result = camera.Project(points[i], projected_point);
+    EXPECT_EQ(is_projected[i], projection_result);
+    if (projection_result == 0) {
+      continue;
+    }
+
+    Vector3 screen_point(320.0F + (projected_point[0] * focal_length), 240.0F - (projected_point[1] * focal_length),
+                         projected_point[2]);
+    EXPECT_TRUE(VectorEqual(screen_points[i], screen_point));
+  }
+
+  // The last point is behind the camera
+  EXPECT_EQ(is_projected[3], 0);
 }
 
 // NOLINTEND(readability-magic-numbers)
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "graphics_pipeline/triangle_mesh.h"
+#include "graphics_pipeline/vector_3.h"
+
+// NOLINTBEGIN(readability-magic-numbers)
+
+class TriangleMeshTest : public ::testing::Test {
+protected:
+  static auto CountBoundaryEdges(const std::vector<TriangleMesh::Edge> &edges) -> long {
+    return std::ranges::count_if(edges, [](const TriangleMesh::Edge &edge) {
+      return edge.triangles[0] != TriangleMesh::NO_TRIANGLE && edge.triangles[1] == TriangleMesh::NO_TRIANGLE;
+    });
+  }
+
+  static auto FindEdge(const std::vector<TriangleMesh::Edge> &edges, unsigned int vertex_0, unsigned int vertex_1)
+      -> const TriangleMesh::Edge * {
+    auto edge = std::ranges::find_if(edges, [&](const TriangleMesh::Edge &candidate) {
+      return candidate.vertices[0] == std::min(vertex_0, vertex_1) &&
+             candidate.vertices[1] == std::max(vertex_0, vertex_1);
+    });
+    return edge == edges.end() ? nullptr : &*edge;
+  }
+};
+
+// A closed mesh has three edges per triangle, each shared by two triangles.
+TEST_F(TriangleMeshTest, EdgesOfClosedMeshes) {
+  TriangleMesh box = TriangleMesh::AxisAlignedBox(Vector3(-1.0F, -1.0F, -1.0F), Vector3(1.0F, 1.0F, 1.0F), 0xFFFFFFFF);
+  EXPECT_EQ(box.GetEdges().size(), 18U);
+  EXPECT_EQ(CountBoundaryEdges(box.GetEdges()), 0);
+
+  for (int subdivisions : {0, 2}) {
+    TriangleMesh sphere = TriangleMesh::Sphere(Vector3(0.0F, 0.0F, 0.0F), 1.0F, subdivisions, 0xFFFFFFFF);
+    const std::vector<TriangleMesh::Edge> &edges = sphere.GetEdges();
+    EXPECT_EQ(edges.size(), sphere.triangles.size() / 2) << subdivisions << " subdivisions";
+    EXPECT_EQ(CountBoundaryEdges(edges), 0) << subdivisions << " subdivisions";
+    for (const auto &edge : edges) {
+      EXPECT_LT(edge.vertices[0], edge.vertices[1]);
+      EXPECT_NE(edge.triangles[0], edge.triangles[1]);
+    }
+  }
+}
+
+// The quad's four outer edges are boundary edges; only the diagonal is shared.
+TEST_F(TriangleMeshTest, BoundaryEdges) {
+  TriangleMesh quad = TriangleMesh::Quad(Vector3(0.0F, 0.0F, 0.0F), Vector3(0.0F, 0.0F, 1.0F),
+                                         Vector3(0.0F, 1.0F, 0.0F), 2.0F, 2.0F);
+  const std::vector<TriangleMesh::Edge> &edges = quad.GetEdges();
+
+  EXPECT_EQ(edges.size(), 5U);
+  EXPECT_EQ(CountBoundaryEdges(edges), 4);
+  for (const auto &edge : edges) {
+    EXPECT_NE(edge.triangles[0], TriangleMesh::NO_TRIANGLE);
+  }
+}
+
+TEST_F(TriangleMeshTest, NonManifoldEdges) {
+  TriangleMesh mesh;
+  mesh.vertices.resize(5);
+  mesh.triangles = {0, 1, 2, 1, 0, 3, 0, 1, 4};
+  const std::vector<TriangleMesh::Edge> &edges = mesh.GetEdges();
+
+  EXPECT_EQ(edges.size(), 7U);
+  const TriangleMesh::Edge *shared_edge = FindEdge(edges, 0, 1);
+  ASSERT_NE(shared_edge, nullptr);
+  EXPECT_EQ(shared_edge->triangles[0], TriangleMesh::NO_TRIANGLE);
+  EXPECT_EQ(shared_edge->triangles[1], TriangleMesh::NO_TRIANGLE);
+  const TriangleMesh::Edge *boundary_edge = FindEdge(edges, 1, 2);
+  ASSERT_NE(boundary_edge, nullptr);
+  EXPECT_EQ(boundary_edge->triangles[0], 0);
+  EXPECT_EQ(boundary_edge->triangles[1], TriangleMesh::NO_TRIANGLE);
+}
+
+TEST_F(TriangleMeshTest, EdgesFollowTriangleEdits) {
+  TriangleMesh mesh;
+  mesh.vertices.resize(4);
+  mesh.triangles = {0, 1, 2, 0, 2, 3};
+  const TriangleMesh::Edge *diagonal = FindEdge(mesh.GetEdges(), 0, 2);
+  ASSERT_NE(diagonal, nullptr);
+  EXPECT_EQ(diagonal->triangles[0], 0);
+  EXPECT_EQ(diagonal->triangles[1], 1);
+
+  // Editing an index in place keeps the size of triangles
+  mesh.triangles[4] = 1;
+  EXPECT_EQ(FindEdge(mesh.GetEdges(), 0, 2)->triangles[1], TriangleMesh::NO_TRIANGLE);
+  EXPECT_EQ(FindEdge(mesh.GetEdges(), 0, 1)->triangles[1], 1);
+  EXPECT_EQ(FindEdge(mesh.GetEdges(), 2, 3), nullptr);
+
+  mesh.triangles.resize(3);
+  EXPECT_EQ(mesh.GetEdges().size(), 3U);
+  EXPECT_EQ(CountBoundaryEdges(mesh.GetEdges()), 3);
+}
+
+// NOLINTEND(readability-magic-numbers)